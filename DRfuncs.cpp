@@ -1,9 +1,16 @@
 /* @file
- * @brief This file contains all functions done by Dillon Roller. This 
- * includes: Polynomial constructor(unsigned value), operator+, operator+=, 
- * operator<<, and compare functions. 
+ * @brief This file contains the functions done by Dillon Roller: the
+ * Polynomial constructor(unsigned value), operator+, operator+=, operator<<
+ * and compare. It also holds the functions added since, credited in their
+ * own comment blocks: operator-, operator-=, the decimal shift and digit
+ * extraction functions, leading, hash, swap, the digit array and character
+ * conversions, to_chars, the machine integer operators and divmod_small,
+ * unshare, and the multiply kernel with its Karatsuba and sparse steps.
  * */
 #include "largeint.h"
+#include "tuning.h"
+#include <algorithm>
+#include <cmath>
 
 /*******************************************************
  *      Function Prototypes for ASL Functions
@@ -13,6 +20,58 @@ ListNode* asl_new( int coeff = 0, int power = 0, ListNode* next = nullptr,
 void asl_delete( ListNode* delnode );
 
 
+/*!
+* @brief number of multiplier digits handled between cancellation checks and
+* progress reports
+*/
+static const size_t MUL_BLOCK = 256;
+
+/*!
+* @brief operands of at least this many digits are multiplied by Karatsuba
+*/
+unsigned karatsuba_digits = KARATSUBA_DIGITS;
+
+/*!
+* @brief operands are multiplied in sparse form when the estimated sparse
+* work, times this margin, is at most the estimated Karatsuba work
+*/
+static const double SPARSE_WORK = 2;
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds the node holding the coefficient of 10^i by
+ * walking in from whichever end of the list is closer. i must be no greater
+ * than the power of head.
+ *
+ * @params[in]  head - most significant node of the list
+ * @params[in]  tail - least significant node of the list
+ * @params[in]  i    - power of 10 to find
+ *
+ * @returns pointer to the node with power i
+ *
+ * *****************************************************/
+static ListNode* findPower( ListNode* head, ListNode* tail, unsigned i )
+{
+    ListNode* curr;
+    
+    if ( i <= unsigned( head->power ) / 2 )
+    {
+        curr = tail;
+        while ( unsigned( curr->power ) != i )
+            curr = curr->prev;
+    }
+    else
+    {
+        curr = head;
+        while ( unsigned( curr->power ) != i )
+            curr = curr->next;
+    }
+    return curr;
+}
+
+
 /********************************************************
  * @author Dillon Roller
  *
@@ -59,34 +118,36 @@ Polynomial::Polynomial( unsigned value )
  * @par Description: Adds two LargeInts together by adding each coefficient
  * of each polynomial to each other that has the same power of 10, accounting 
  * for carries. The resultant sum is a polynomial that is stored in a newly
- * created LargeInt
+ * created LargeInt. The longer operand is picked from the power of its head
+ * node, so no compare() pass is needed, and carries are resolved with a
+ * compare and subtract instead of a division by 10 per digit.
  *
  * @params[in]  lhs - first LargeInt to be added
  * @params[in]  rhs - second LargeInt to be added
  *
- * @returns A reference to sum (LargeInt holding sum)
+ * @returns sum - LargeInt holding sum
  *
  * *****************************************************/
-const LargeInt& operator+( const LargeInt& lhs, const LargeInt& rhs )
+LargeInt operator+( const LargeInt& lhs, const LargeInt& rhs )
 {
-    LargeInt* sum = new(nothrow) LargeInt();
+    LargeInt sum;
     int pow = 1, carry = 0, coeff;
     ListNode *gtptr = lhs.tail;
     ListNode *ltptr = rhs.tail;
     
     
-    //set greaterptr and lesserptr to appropriate LargeInts
-    if ( rhs > lhs )
+    //set greaterptr to the LargeInt with more digits
+    if ( rhs.head->power > lhs.head->power )
     {
         gtptr = rhs.tail;
         ltptr = lhs.tail;
     }
 
-    ListNode* curr = sum->tail;
+    ListNode* curr = sum.tail;
 
     //handles first digit
     coeff = gtptr->coeff + ltptr->coeff;
-    carry = coeff / 10;
+    carry = ( coeff > 9 );
     curr->coeff = coeff - ( carry * 10 );
     gtptr = gtptr->prev;
     ltptr = ltptr->prev;
@@ -95,7 +156,7 @@ const LargeInt& operator+( const LargeInt& lhs, const LargeInt& rhs )
     while ( ltptr != nullptr )
     {
         coeff = gtptr->coeff + ltptr->coeff + carry;
-        carry = coeff / 10;
+        carry = ( coeff > 9 );
         curr->prev = asl_new ( coeff - ( carry * 10 ), pow++, curr );
         
         gtptr = gtptr->prev;
@@ -108,7 +169,7 @@ const LargeInt& operator+( const LargeInt& lhs, const LargeInt& rhs )
     while ( gtptr != nullptr )
     {
         coeff = gtptr->coeff + carry;
-        carry = coeff / 10;
+        carry = ( coeff > 9 );
         coeff = coeff - ( carry * 10 );
 
         curr->prev = asl_new( coeff, pow++, curr );
@@ -126,8 +187,77 @@ const LargeInt& operator+( const LargeInt& lhs, const LargeInt& rhs )
     }
     
     //Associate new polynomial with LargeInt
-    sum->head = curr;
-    return *sum;
+    sum.head = curr;
+    return sum;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Subtracts rhs from lhs digit by digit starting at the
+ * 0th power, borrowing from the next power when a coefficient goes negative.
+ * Leading zeros are removed from the difference so the power of the head
+ * node still gives the length of the LargeInt. Since LargeInt is unsigned,
+ * a borrow out of the most significant digit means lhs < rhs and the
+ * result is 0.
+ *
+ * @params[in]  lhs - LargeInt to subtract from
+ * @params[in]  rhs - LargeInt to be subtracted
+ *
+ * @returns diff - LargeInt holding lhs - rhs, or 0 if lhs < rhs
+ *
+ * *****************************************************/
+LargeInt operator-( const LargeInt& lhs, const LargeInt& rhs )
+{
+    LargeInt diff;
+
+    //rhs has more digits, so the difference would be negative
+    if ( rhs.head->power > lhs.head->power )
+        return diff;
+
+    int pow = 1, borrow, coeff;
+    ListNode *gtptr = lhs.tail;
+    ListNode *ltptr = rhs.tail;
+    ListNode *curr = diff.tail;
+
+    //handles first digit
+    coeff = gtptr->coeff - ltptr->coeff;
+    borrow = ( coeff < 0 );
+    curr->coeff = coeff + ( borrow * 10 );
+    gtptr = gtptr->prev;
+    ltptr = ltptr->prev;
+
+    //subtract until we run out of digits in rhs
+    while ( ltptr != nullptr )
+    {
+        coeff = gtptr->coeff - ltptr->coeff - borrow;
+        borrow = ( coeff < 0 );
+        curr->prev = asl_new( coeff + ( borrow * 10 ), pow++, curr );
+
+        gtptr = gtptr->prev;
+        ltptr = ltptr->prev;
+        curr = curr->prev;
+    }
+
+    //copy remaining digits of lhs, accounting for borrow
+    while ( gtptr != nullptr )
+    {
+        coeff = gtptr->coeff - borrow;
+        borrow = ( coeff < 0 );
+        curr->prev = asl_new( coeff + ( borrow * 10 ), pow++, curr );
+
+        gtptr = gtptr->prev;
+        curr = curr->prev;
+    }
+
+    diff.head = curr;
+
+    //lhs was less than rhs, difference is 0
+    if ( borrow != 0 )
+        return LargeInt();
+
+    diff.stripZeros();
+    return diff;
 }
 
 /********************************************************
@@ -143,13 +273,32 @@ const LargeInt& operator+( const LargeInt& lhs, const LargeInt& rhs )
  * *****************************************************/
 ostream& operator<<( ostream& out, const LargeInt& num )
 { 
-    ListNode* temp = num.head;
-    while( temp != nullptr )
-    {
-        out << temp->coeff;
-        temp = temp->next;
-    }
-    return out;
+    //format everything first and hand it to the stream in one write
+    string text( num.length(), '0' );
+
+    num.toChars( &text[0] );
+    return out.write( text.data(), text.size() );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Formats the decimal digits of a LargeInt into a
+ * caller's buffer, most significant first, with no terminating null.
+ *
+ * @params[in]  first - start of the buffer
+ * @params[in]  last  - end of the buffer
+ * @params[in]  num   - LargeInt to format
+ *
+ * @returns end of the digits written, or nullptr if the buffer holds
+ * fewer than num.length() characters (nothing is written then)
+ *
+ * *****************************************************/
+char* to_chars( char* first, char* last, const LargeInt& num )
+{
+    if ( last - first < ptrdiff_t( num.length() ) )
+        return nullptr;
+    return num.toChars( first );
 }
 
 /********************************************************
@@ -210,4 +359,1067 @@ const LargeInt& LargeInt::operator+=( const LargeInt& rhs )
     return *this = *this + rhs;
 }
 
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Overloads -= operator. Subtracts a LargeInt from 'this'
+ * LargeInt and stores it back into 'this' 
+ *
+ * @params[in]  rhs - LargeInt to be subtracted from 'this'
+ *
+ * @returns reference to new difference(for chaining purposes)
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::operator-=( const LargeInt& rhs )
+{
+    return *this = *this - rhs;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplies 'this' by 10^k by appending k zero nodes at
+ * the 0th power and renumbering the existing powers. No digits are
+ * multiplied or reallocated.
+ *
+ * @params[in]  k - power of 10 to multiply by
+ *
+ * @returns reference to 'this' (for chaining purposes)
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::shift_left10( unsigned k )
+{
+    //zero stays zero
+    if ( k == 0 || ( head == tail && head->coeff == 0 ) )
+        return *this;
+
+    unshare();
+
+    //renumber existing digits
+    for ( ListNode* curr = head; curr != nullptr; curr = curr->next )
+        curr->power += k;
+
+    //append new low-order zeros
+    for ( int i = k - 1; i >= 0; i-- )
+    {
+        tail->next = asl_new( 0, i, nullptr, tail );
+        tail = tail->next;
+    }
+    return *this;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Divides 'this' by 10^k, discarding the k low-order
+ * nodes and renumbering the powers of the rest.
+ *
+ * @params[in]  k - power of 10 to divide by
+ *
+ * @returns reference to 'this' (for chaining purposes)
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::shift_right10( unsigned k )
+{
+    if ( k == 0 )
+        return *this;
+
+    //every digit is shifted out
+    if ( k > unsigned( head->power ) )
+    {
+        freePoly();
+        head = tail = asl_new();
+        return *this;
+    }
+
+    unshare();
+
+    //drop low-order digits
+    for ( unsigned i = 0; i < k; i++ )
+    {
+        ListNode* temp = tail;
+        tail = tail->prev;
+        asl_delete( temp );
+    }
+    tail->next = nullptr;
+
+    //renumber remaining digits
+    for ( ListNode* curr = head; curr != nullptr; curr = curr->next )
+        curr->power -= k;
+
+    return *this;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Reduces 'this' modulo 10^k by discarding every node
+ * with power k or higher. The low-order powers are unchanged, so only the
+ * discarded nodes and any exposed leading zeros are touched.
+ *
+ * @params[in]  k - power of 10 to reduce by
+ *
+ * @returns reference to 'this' (for chaining purposes)
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::mod_pow10( unsigned k )
+{
+    if ( k == 0 )
+    {
+        freePoly();
+        head = tail = asl_new();
+        return *this;
+    }
+
+    unshare();
+
+    //remove high-order digits and any leading zeros they expose
+    while ( head != tail && 
+        ( unsigned( head->power ) >= k || head->coeff == 0 ) )
+    {
+        ListNode* temp = head;
+        head = head->next;
+        asl_delete( temp );
+    }
+    head->prev = nullptr;
+
+    return *this;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Returns the coefficient of 10^i without building any
+ * new LargeInt.
+ *
+ * @params[in]  i - power of 10 of the digit
+ *
+ * @returns digit at power i (0 past the most significant digit)
+ *
+ * *****************************************************/
+int LargeInt::digit( unsigned i ) const
+{
+    if ( i > unsigned( head->power ) )
+        return 0;
+
+    return findPower( head, tail, i )->coeff;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Copies the digits with powers i through j - 1 into a
+ * new LargeInt, i.e. (this / 10^i) mod 10^(j - i). Only the nodes up to
+ * the range and the copied digits are visited.
+ *
+ * @params[in]  i - lowest power to extract
+ * @params[in]  j - one past the highest power to extract
+ *
+ * @returns LargeInt holding the extracted digits
+ *
+ * *****************************************************/
+LargeInt LargeInt::digits( unsigned i, unsigned j ) const
+{
+    LargeInt result;
+
+    if ( j <= i || i > unsigned( head->power ) )
+        return result;
+
+    //copy digits from power i upward
+    ListNode* src = findPower( head, tail, i );
+    ListNode* curr = result.tail;
+    int pow = 1;
+
+    curr->coeff = src->coeff;
+    src = src->prev;
+    while ( src != nullptr && unsigned( src->power ) < j )
+    {
+        curr->prev = asl_new( src->coeff, pow++, curr );
+        curr = curr->prev;
+        src = src->prev;
+    }
+
+    result.head = curr;
+    result.stripZeros();
+    return result;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Converts the LargeInt to its value as a machine
+ * integer by reading the digits from the most significant down. Only the
+ * low-order 19 digits are exact, so callers check length() first.
+ *
+ * @params  none
+ *
+ * @returns value of 'this' as an unsigned 64 bit integer
+ *
+ * *****************************************************/
+uint64_t LargeInt::to_uint64() const
+{
+    uint64_t value = 0;
+
+    for ( ListNode* curr = head; curr != nullptr; curr = curr->next )
+        value = value * 10 + curr->coeff;
+
+    return value;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Reads the first n digits from the most significant
+ * down. A number shorter than n digits is padded with zeros on the right,
+ * so numbers of one length compare the same as their leading digits.
+ *
+ * @params[in]  n - number of digits to read, at most 19
+ *
+ * @returns first n digits as an unsigned 64 bit integer
+ *
+ * *****************************************************/
+uint64_t LargeInt::leading( unsigned n ) const
+{
+    uint64_t value = 0;
+    ListNode* curr = head;
+
+    for ( unsigned i = 0; i < n; i++ )
+    {
+        value = value * 10 + ( curr != nullptr ? curr->coeff : 0 );
+        if ( curr != nullptr )
+            curr = curr->next;
+    }
+    return value;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Hashes every digit. The digits are packed 18 at a time
+ * into a word, and each word is mixed into the hash with a multiply and
+ * xor-shift step, so equal numbers hash equal and nearby numbers spread.
+ *
+ * @params  none
+ *
+ * @returns hash of the digits
+ *
+ * *****************************************************/
+size_t LargeInt::hash() const
+{
+    uint64_t h = length(), word = 0;
+    unsigned count = 0;
+
+    for ( ListNode* curr = head; curr != nullptr; curr = curr->next )
+    {
+        word = word * 10 + curr->coeff;
+        if ( ++count == 18 || curr->next == nullptr )
+        {
+            h = ( h ^ word ) * 0x9e3779b97f4a7c15ull;
+            h ^= h >> 29;
+            word = count = 0;
+        }
+    }
+    return h;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Exchanges the lists, and any shared reference counts,
+ * of two LargeInts. No nodes are copied or freed.
+ *
+ * @params[in,out] other - LargeInt to exchange with
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void LargeInt::swap( LargeInt& other )
+{
+    atomic<int>* count = refs.load( memory_order_relaxed );
+
+    refs.store( other.refs.load( memory_order_relaxed ), memory_order_relaxed );
+    other.refs.store( count, memory_order_relaxed );
+    std::swap( head, other.head );
+    std::swap( tail, other.tail );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Copies the coefficients of the polynomial into a digit
+ * array, least significant digit first, so array index equals power. Used
+ * by the kernels that need random access to digits.
+ *
+ * @params[out] num - array to receive the digits
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void Polynomial::toDigits( vector<int>& num ) const
+{
+    num.assign( head->power + 1, 0 );
+
+    for ( ListNode* curr = tail; curr != nullptr; curr = curr->prev )
+        num[curr->power] = curr->coeff;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Writes the coefficients as decimal characters, most
+ * significant first. Powers with no node between two nodes, or below the
+ * tail, are written as zeros, so the output is right even when the list
+ * skips zero digits.
+ *
+ * @params[in]  first - where to write head->power + 1 characters
+ *
+ * @returns end of the characters written
+ *
+ * *****************************************************/
+char* Polynomial::toChars( char* first ) const
+{
+    for ( ListNode* curr = head; curr != nullptr; curr = curr->next )
+    {
+        *first++ = '0' + curr->coeff;
+
+        //zeros for the powers down to the next node
+        int below = ( curr->next != nullptr ) ? curr->next->power : -1;
+        for ( int p = curr->power - 1; p > below; p-- )
+            *first++ = '0';
+    }
+    return first;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Replaces the polynomial with the digits of a digit
+ * array, least significant digit first. Leading zeros in the array are
+ * skipped so the power of head stays the length of the number.
+ *
+ * @params[in]  num - array of digits to store
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void Polynomial::fromDigits( const vector<int>& num )
+{
+    int top = num.size() - 1;
+
+    freePoly();
+
+    //skip leading zeros
+    while ( top > 0 && num[top] == 0 )
+        top--;
+
+    //special case of empty array
+    if ( top < 0 )
+    {
+        head = tail = asl_new();
+        return;
+    }
+
+    //store most significant digit, then the rest
+    head = asl_new( num[top], top );
+    ListNode* cur = head;
+
+    for ( int i = top - 1; i >= 0; i-- )
+    {
+        cur->next = asl_new( num[i], i, nullptr, cur );
+        cur = cur->next;
+    }
+    tail = cur;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Adds a machine integer to 'this' in place. The digits
+ * of value are added from the 0th power up and the loop stops as soon as
+ * nothing is left to carry, so adding a small value usually touches only
+ * the last few nodes. New nodes are added at head only for a final carry.
+ *
+ * @params[in]  value - integer to be added to 'this'
+ *
+ * @returns reference to 'this' (for chaining purposes)
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::operator+=( uint64_t value )
+{
+    unshare();
+
+    uint64_t carry = value, coeff;
+    ListNode* curr = tail;
 
+    while ( carry != 0 && curr != nullptr )
+    {
+        coeff = curr->coeff + carry % 10;
+        carry = carry / 10 + ( coeff > 9 );
+        curr->coeff = coeff - ( coeff > 9 ) * 10;
+        curr = curr->prev;
+    }
+
+    //carry out of the most significant digit becomes new digits
+    while ( carry != 0 )
+    {
+        head->prev = asl_new( carry % 10, head->power + 1, head );
+        head = head->prev;
+        carry /= 10;
+    }
+    return *this;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Subtracts a machine integer from 'this' in place,
+ * stopping as soon as nothing is left to borrow. Leading zeros left by the
+ * borrow are removed. LargeInt is unsigned, so a borrow out of the most
+ * significant digit leaves 'this' as 0.
+ *
+ * @params[in]  value - integer to be subtracted from 'this'
+ *
+ * @returns reference to 'this' (for chaining purposes)
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::operator-=( uint64_t value )
+{
+    unshare();
+
+    uint64_t borrow = value;
+    int coeff;
+    ListNode* curr = tail;
+
+    while ( borrow != 0 && curr != nullptr )
+    {
+        coeff = curr->coeff - int( borrow % 10 );
+        borrow = borrow / 10 + ( coeff < 0 );
+        curr->coeff = coeff + ( coeff < 0 ) * 10;
+        curr = curr->prev;
+    }
+
+    //value was greater than 'this'
+    if ( borrow != 0 )
+    {
+        freePoly();
+        head = tail = asl_new();
+        return *this;
+    }
+
+    stripZeros();
+    return *this;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplies 'this' by a machine integer in place in a
+ * single pass from the 0th power up. Multipliers up to UINT64_MAX / 10
+ * keep the running product in 64 bits; larger ones need 128 bits.
+ *
+ * @params[in]  value - integer to multiply 'this' by
+ *
+ * @returns reference to 'this' (for chaining purposes)
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::operator*=( uint64_t value )
+{
+    //product with zero is zero
+    if ( value == 0 || is_zero() )
+    {
+        freePoly();
+        head = tail = asl_new();
+        return *this;
+    }
+
+    unshare();
+
+    uint64_t carry = 0;
+    ListNode* curr;
+
+    if ( value <= UINT64_MAX / 10 )
+    {
+        for ( curr = tail; curr != nullptr; curr = curr->prev )
+        {
+            uint64_t prod = curr->coeff * value + carry;
+            carry = prod / 10;
+            curr->coeff = prod - carry * 10;
+        }
+    }
+    else
+    {
+        unsigned __int128 prod, wide = 0;
+        for ( curr = tail; curr != nullptr; curr = curr->prev )
+        {
+            prod = curr->coeff * ( unsigned __int128 ) value + wide;
+            wide = prod / 10;
+            curr->coeff = prod - wide * 10;
+        }
+        //final carry is below value, so it fits in 64 bits
+        carry = wide;
+    }
+
+    //carry out of the most significant digit becomes new digits
+    while ( carry != 0 )
+    {
+        head->prev = asl_new( carry % 10, head->power + 1, head );
+        head = head->prev;
+        carry /= 10;
+    }
+    return *this;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Divides 'this' by a machine integer in place with
+ * short division from the most significant digit down, and returns the
+ * remainder. Leading zeros of the quotient are removed. Dividing by 0
+ * leaves 'this' unchanged and returns 0.
+ *
+ * @params[in]  value - integer to divide 'this' by
+ *
+ * @returns remainder of 'this' divided by value
+ *
+ * *****************************************************/
+uint64_t LargeInt::divmod_small( uint64_t value )
+{
+    uint64_t rem = 0, q;
+    ListNode* curr;
+
+    if ( value == 0 )
+        return 0;
+
+    unshare();
+
+    if ( value <= UINT64_MAX / 10 )
+    {
+        for ( curr = head; curr != nullptr; curr = curr->next )
+        {
+            rem = rem * 10 + curr->coeff;
+            q = rem / value;
+            curr->coeff = q;
+            rem -= q * value;
+        }
+    }
+    else
+    {
+        unsigned __int128 wide = 0;
+        for ( curr = head; curr != nullptr; curr = curr->next )
+        {
+            wide = wide * 10 + curr->coeff;
+            q = wide / value;
+            curr->coeff = q;
+            wide -= ( unsigned __int128 ) q * value;
+        }
+        rem = wide;
+    }
+
+    stripZeros();
+    return rem;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Overloads prefix ++ operator. Adds 1 to 'this' in
+ * place; only the trailing 9s and the digit before them change, so a run
+ * of increments costs O(1) per increment on average.
+ *
+ * @params  none
+ *
+ * @returns reference to 'this' after the increment
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::operator++()
+{
+    return *this += 1;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Overloads postfix ++ operator. Adds 1 to 'this' in
+ * place and returns a copy of the old value.
+ *
+ * @params  none
+ *
+ * @returns LargeInt holding the value before the increment
+ *
+ * *****************************************************/
+LargeInt LargeInt::operator++( int )
+{
+    LargeInt old( *this );
+
+    *this += 1;
+    return old;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Overloads prefix -- operator. Subtracts 1 from 'this'
+ * in place; 0 stays 0.
+ *
+ * @params  none
+ *
+ * @returns reference to 'this' after the decrement
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::operator--()
+{
+    return *this -= 1;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Overloads postfix -- operator. Subtracts 1 from 'this'
+ * in place and returns a copy of the old value.
+ *
+ * @params  none
+ *
+ * @returns LargeInt holding the value before the decrement
+ *
+ * *****************************************************/
+LargeInt LargeInt::operator--( int )
+{
+    LargeInt old( *this );
+
+    *this -= 1;
+    return old;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Adds a LargeInt and a machine integer with a copy and
+ * one in place pass, without building a LargeInt for the integer.
+ *
+ * @params[in]  lhs - LargeInt to be added
+ * @params[in]  rhs - integer to be added
+ *
+ * @returns sum - LargeInt holding lhs + rhs
+ *
+ * *****************************************************/
+LargeInt operator+( const LargeInt& lhs, uint64_t rhs )
+{
+    LargeInt sum( lhs );
+
+    sum += rhs;
+    return sum;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Adds a machine integer and a LargeInt, see above.
+ *
+ * @params[in]  lhs - integer to be added
+ * @params[in]  rhs - LargeInt to be added
+ *
+ * @returns sum - LargeInt holding lhs + rhs
+ *
+ * *****************************************************/
+LargeInt operator+( uint64_t lhs, const LargeInt& rhs )
+{
+    return rhs + lhs;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Subtracts a machine integer from a LargeInt with a
+ * copy and one in place pass. The result is 0 if lhs < rhs.
+ *
+ * @params[in]  lhs - LargeInt to subtract from
+ * @params[in]  rhs - integer to be subtracted
+ *
+ * @returns diff - LargeInt holding lhs - rhs
+ *
+ * *****************************************************/
+LargeInt operator-( const LargeInt& lhs, uint64_t rhs )
+{
+    LargeInt diff( lhs );
+
+    diff -= rhs;
+    return diff;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplies a LargeInt by a machine integer with a copy
+ * and one in place pass, instead of the general digit by digit product.
+ *
+ * @params[in]  lhs - LargeInt multiplicand
+ * @params[in]  rhs - integer multiplier
+ *
+ * @returns prod - LargeInt holding lhs * rhs
+ *
+ * *****************************************************/
+LargeInt operator*( const LargeInt& lhs, uint64_t rhs )
+{
+    LargeInt prod( lhs );
+
+    prod *= rhs;
+    return prod;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplies a machine integer by a LargeInt, see above.
+ *
+ * @params[in]  lhs - integer multiplicand
+ * @params[in]  rhs - LargeInt multiplier
+ *
+ * @returns prod - LargeInt holding lhs * rhs
+ *
+ * *****************************************************/
+LargeInt operator*( uint64_t lhs, const LargeInt& rhs )
+{
+    return rhs * lhs;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Gives 'this' its own copy of a list shared through
+ * copyPoly, so it can be written without changing the other owners. Every
+ * member function that writes to existing nodes calls this first. A list
+ * whose other owners are all gone is kept as is. A list in static storage
+ * is always copied.
+ *
+ * @params  none
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void Polynomial::unshare()
+{
+    atomic<int>* count = refs.load( memory_order_relaxed );
+
+    if ( count == nullptr )
+        return;
+
+    refs.store( nullptr, memory_order_relaxed );
+
+    //other owners have let go, the list is ours alone
+    if ( count != &immortal && count->load( memory_order_acquire ) == 1 )
+    {
+        delete count;
+        return;
+    }
+
+    //copy the nodes, then release our hold on the shared list
+    ListNode* oldhead = head;
+    ListNode* oldtail = tail;
+    ListNode* src = head->next;
+    ListNode* curr = asl_new( head->coeff, head->power );
+
+    head = curr;
+    while ( src != nullptr )
+    {
+        curr->next = asl_new( src->coeff, src->power, nullptr, curr );
+        curr = curr->next;
+        src = src->next;
+    }
+    tail = curr;
+
+    //the last owner to let go frees the old list
+    release( oldhead, oldtail, count );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Removes the leading zero nodes from the head of the
+ * list, keeping at least one digit.
+ *
+ * @params  none
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void Polynomial::stripZeros()
+{
+    while ( head != tail && head->coeff == 0 )
+    {
+        ListNode* temp = head;
+        head = head->next;
+        asl_delete( temp );
+    }
+    head->prev = nullptr;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Counts the nonzero digits of a list.
+ *
+ * @params[in]  head - most significant node of the list
+ *
+ * @returns number of nonzero coefficients
+ *
+ * *****************************************************/
+static uint64_t nonzeroDigits( ListNode* head )
+{
+    uint64_t count = 0;
+
+    for ( ; head != nullptr; head = head->next )
+        if ( head->coeff != 0 )
+            count++;
+    return count;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Estimates the work of a SparseInt product: every pair
+ * of terms passes through a heap holding a row for each term of the side
+ * with fewer terms.
+ *
+ * @params[in]  lterms - nonzero digits of the multiplicand
+ * @params[in]  rterms - nonzero digits of the multiplier
+ *
+ * @returns the pairs of terms times the log of the rows
+ *
+ * *****************************************************/
+static double sparseWork( uint64_t lterms, uint64_t rterms )
+{
+    double rows = double( min( lterms, rterms ) );
+
+    return double( lterms ) * rterms * log2( rows + 1 );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Estimates the work of multiplying every digit: each
+ * slice of the multiplier's length of the longer number is a Karatsuba
+ * product, which grows as the length to the power log2( 3 ).
+ *
+ * @params[in]  llen - digits of the multiplicand
+ * @params[in]  rlen - digits of the multiplier
+ *
+ * @returns the slices times the work of one slice
+ *
+ * *****************************************************/
+static double denseWork( size_t llen, size_t rlen )
+{
+    double shorter = double( min( llen, rlen ) );
+
+    return double( max( llen, rlen ) ) / shorter * pow( shorter, log2( 3.0 ) );
+}
+
+/*!
+* @brief state shared by the recursion of one Karatsuba multiplication: the
+* cancellation token and the progress counted in multiplier digits
+*/
+struct KaratsubaJob
+{
+    const CancelToken* cancel;  /*!< checked at each split, may be nullptr */
+    const ProgressFn* progress; /*!< told the digits done, may be empty */
+    size_t done;                /*!< multiplier digits done so far */
+    size_t reported;            /*!< done at the last progress report */
+    size_t total;               /*!< multiplier digits of the whole product */
+};
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Karatsuba multiplication of two n digit arrays. With
+ * each operand split into a low half of lo digits and a high half,
+ * a * b = z2 10^(2 lo) + z1 10^lo + z0 where z0 = a0 b0, z2 = a1 b1 and
+ * z1 = ( a0 + a1 )( b0 + b1 ) - z0 - z2, three half size products instead
+ * of four. Below karatsuba_digits the product is done by schoolbook. The
+ * output is left as column sums; the caller resolves the carries.
+ *
+ * The call stands for share of the job's multiplier digits. A split passes
+ * a third of it to each half size product, and a schoolbook product adds
+ * its share to the digits done, reporting progress every MUL_BLOCK digits.
+ *
+ * @params[in]     a     - first operand, n digits
+ * @params[in]     b     - second operand, n digits
+ * @params[in]     n     - number of digits
+ * @params[out]    out   - 2n column sums of a * b
+ * @params[in,out] job   - cancellation and progress of the multiplication
+ * @params[in]     share - multiplier digits of the job this product covers
+ *
+ * @returns true if the product was computed, false if cancelled
+ *
+ * *****************************************************/
+static bool karatsuba( const int64_t* a, const int64_t* b, size_t n,
+    int64_t* out, KaratsubaJob& job, size_t share )
+{
+    if ( n < karatsuba_digits || n < 2 )
+    {
+        fill( out, out + 2 * n, 0 );
+        for ( size_t i = 0; i < n; i++ )
+        {
+            if ( a[i] == 0 )
+                continue;
+            for ( size_t j = 0; j < n; j++ )
+                out[i + j] += a[i] * b[j];
+        }
+
+        job.done += share;
+        if ( *job.progress && job.done != job.reported && 
+            ( job.done - job.reported >= MUL_BLOCK || job.done == job.total ) )
+        {
+            job.reported = job.done;
+            ( *job.progress )( job.done, job.total );
+        }
+        return true;
+    }
+
+    if ( job.cancel != nullptr && job.cancel->cancelled() )
+        return false;
+
+    //z0 into out[0, 2 lo), z2 into out[2 lo, 2n); z1 takes the remainder
+    //of the share, so the last product finishes the count
+    size_t lo = n / 2, hi = n - lo;
+    size_t third = share / 3;
+    if ( !karatsuba( a, b, lo, out, job, third ) || 
+        !karatsuba( a + lo, b + lo, hi, out + 2 * lo, job, third ) )
+        return false;
+
+    //z1 from the sums of the halves
+    vector<int64_t> sa( a + lo, a + n ), sb( b + lo, b + n ), mid( 2 * hi );
+    for ( size_t i = 0; i < lo; i++ )
+    {
+        sa[i] += a[i];
+        sb[i] += b[i];
+    }
+    if ( !karatsuba( sa.data(), sb.data(), hi, mid.data(), job, 
+        share - 2 * third ) )
+        return false;
+
+    for ( size_t i = 0; i < 2 * lo; i++ )
+        mid[i] -= out[i];
+    for ( size_t i = 0; i < 2 * hi; i++ )
+        mid[i] -= out[2 * lo + i];
+    for ( size_t i = 0; i < 2 * hi; i++ )
+        out[lo + i] += mid[i];
+    return true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplication kernel. Both numbers are copied to digit
+ * arrays and every digit product is added into a 64 bit column for its
+ * power, so the inner loop is a plain multiply-add over contiguous memory
+ * and the carries are resolved in a single pass at the end. The shorter
+ * number drives the outer loop, which runs in blocks of MUL_BLOCK digits;
+ * the cancellation token is checked and progress reported between blocks.
+ * Operands with so few nonzero digits that sparseWork() is well below
+ * denseWork() are multiplied as SparseInts instead.
+ * From karatsuba_digits on, the whole multiplier times each slice of its
+ * length of the longer number is one karatsuba() call, which checks the
+ * token and reports progress from inside its recursion.
+ *
+ * @params[in]  lhs      - LargeInt multiplicand
+ * @params[in]  rhs      - LargeInt multiplier
+ * @params[out] product  - lhs * rhs, unchanged if cancelled
+ * @params[in]  cancel   - token checked as the work proceeds, may be nullptr
+ * @params[in]  progress - called with the multiplier digits done as the work
+ *                         proceeds, may be empty
+ *
+ * @returns true if the product was computed, false if cancelled
+ *
+ * *****************************************************/
+bool multiply( const LargeInt& lhs, const LargeInt& rhs, LargeInt& product,
+    const CancelToken* cancel, const ProgressFn& progress )
+{
+    vector<int> a, b, digits;
+    vector<uint64_t> col;
+
+    //product with zero is zero
+    if ( lhs.is_zero() || rhs.is_zero() )
+    {
+        product = LargeInt();
+        return true;
+    }
+
+    //mostly zero operands, where merging the pairs of nonzero digits costs
+    //less than a Karatsuba product over every digit
+    if ( sparseWork( nonzeroDigits( lhs.head ), nonzeroDigits( rhs.head ) ) 
+        * SPARSE_WORK <= denseWork( lhs.length(), rhs.length() ) )
+    {
+        product = ( SparseInt( lhs ) * SparseInt( rhs ) ).to_largeint();
+        if ( progress )
+            progress( min( lhs.length(), rhs.length() ), 
+                min( lhs.length(), rhs.length() ) );
+        return true;
+    }
+
+    lhs.toDigits( a );
+    rhs.toDigits( b );
+    if ( a.size() < b.size() )
+        a.swap( b );
+    col.assign( a.size() + b.size(), 0 );
+
+    if ( b.size() >= karatsuba_digits )
+    {
+        size_t n = b.size(), slices = ( a.size() + n - 1 ) / n;
+        vector<int64_t> x( n ), y( b.begin(), b.end() ), part( 2 * n );
+        KaratsubaJob job = { cancel, &progress, 0, 0, n };
+
+        //slices of the longer number, the last one zero padded, each
+        //covering an even part of the progress
+        for ( size_t k = 0; k < slices; k++ )
+        {
+            size_t i = k * n, stop = min( i + n, a.size() );
+            size_t share = n * ( k + 1 ) / slices - n * k / slices;
+
+            fill( copy( a.begin() + i, a.begin() + stop, x.begin() ), 
+                x.end(), 0 );
+            if ( !karatsuba( x.data(), y.data(), n, part.data(), job, 
+                share ) )
+                return false;
+
+            size_t used = min( 2 * n, col.size() - i );
+            for ( size_t c = 0; c < used; c++ )
+                col[i + c] += part[c];
+        }
+    }
+    else
+    {
+        //add each digit product into its column
+        for ( size_t start = 0; start < b.size(); start += MUL_BLOCK )
+        {
+            if ( cancel != nullptr && cancel->cancelled() )
+                return false;
+
+            size_t end = min( start + MUL_BLOCK, b.size() );
+            for ( size_t j = start; j < end; j++ )
+            {
+                uint64_t d = b[j];
+                uint64_t* out = &col[j];
+
+                if ( d == 0 )
+                    continue;
+                for ( size_t i = 0; i < a.size(); i++ )
+                    out[i] += d * a[i];
+            }
+
+            if ( progress )
+                progress( end, b.size() );
+        }
+    }
+
+    //resolve carries
+    uint64_t carry = 0;
+    digits.resize( col.size() );
+    for ( size_t i = 0; i < col.size(); i++ )
+    {
+        carry += col[i];
+        digits[i] = carry % 10;
+        carry /= 10;
+    }
+
+    product.fromDigits( digits );
+    return true;
+}
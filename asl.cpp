@@ -4,9 +4,49 @@
 #include "largeint.h"
 
 /*!
-* @brief pointer to the top of ASL stack
+* @brief pointer to the top of ASL stack. Each thread has its own stack so
+* no locking is needed; a node freed by another thread than the one that
+* allocated it just joins the freeing thread's stack.
 */
-static ListNode* g_asl = nullptr; 
+static thread_local ListNode* g_asl = nullptr; 
+
+/*!
+* @brief Returns the nodes left on a thread's ASL stack to the heap when the
+* thread exits, so threads that come and go do not leak their free nodes
+*/
+struct AslDrain
+{
+    ~AslDrain()
+    {
+        while ( g_asl != nullptr )
+        {
+            ListNode* temp = g_asl;
+            g_asl = g_asl ->next;
+            delete temp;
+        }
+    }
+};
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: 
+ * Makes sure the calling thread drains its ASL stack on exit. The drain is
+ * registered the first time it is reached in each thread, which is only
+ * ever from a stack that is empty, so the common paths never pay for it.
+ *
+ * @params  none
+ *
+ * @returns none
+ *
+ * *****************************************************/
+static void drainOnExit()
+{
+    static thread_local AslDrain drain;
+
+    ( void ) drain;
+}
 
 /********************************************************
  * @author Chezka Gaddi, Dillon Roller
@@ -31,15 +71,17 @@ ListNode* asl_new( int coeff, int power, ListNode* next, ListNode* prev )
     {
         ListNode* newnode = g_asl;
 
+        //pop before next is overwritten
+        g_asl = g_asl ->next;
         newnode ->coeff = coeff;
         newnode ->power = power;
         newnode ->next = next;
         newnode ->prev = prev;
-        g_asl = g_asl ->next;
 
         return newnode;
     }
 
+    drainOnExit();
     return new ( nothrow ) ListNode ( coeff, power, next, prev );
 }
 
@@ -57,6 +99,9 @@ ListNode* asl_new( int coeff, int power, ListNode* next, ListNode* prev )
  * *****************************************************/
 void asl_delete ( ListNode* delnode ) 
 {
+    if ( g_asl == nullptr )
+        drainOnExit();
+
     delnode ->next = g_asl;
     g_asl = delnode;
 } 
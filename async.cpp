@@ -0,0 +1,199 @@
+/* @file
+ * @brief This file contains the asynchronous LargeInt operations and the
+ * pool of worker threads they run on: async_multiply and async_add.
+ * */
+#include "largeint.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+
+/*!
+* @brief Fixed pool of worker threads that run queued jobs in order
+*/
+class Executor
+{
+    private:
+        vector<thread> workers;         /*!< threads running jobs */
+        queue<function<void()>> jobs;   /*!< jobs waiting for a thread */
+        mutex lock;                     /*!< guards jobs and stopping */
+        condition_variable ready;       /*!< signalled when a job is queued */
+        bool stopping = false;          /*!< set when the pool shuts down */
+
+        void run();
+
+    public:
+        Executor( unsigned threads );
+        ~Executor();
+
+        void submit( function<void()> job );
+};
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Starts the worker threads of the pool.
+ *
+ * @params[in]  threads - number of worker threads
+ *
+ * @returns none
+ *
+ * *****************************************************/
+Executor::Executor( unsigned threads )
+{
+    for ( unsigned i = 0; i < threads; i++ )
+        workers.emplace_back( &Executor::run, this );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Lets the workers finish the queued jobs, then joins
+ * them.
+ *
+ * @params  none
+ *
+ * @returns none
+ *
+ * *****************************************************/
+Executor::~Executor()
+{
+    {
+        lock_guard<mutex> guard( lock );
+        stopping = true;
+    }
+    ready.notify_all();
+
+    for ( thread& worker : workers )
+        worker.join();
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Queues a job for the next free worker.
+ *
+ * @params[in]  job - function to run on a worker thread
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void Executor::submit( function<void()> job )
+{
+    {
+        lock_guard<mutex> guard( lock );
+        jobs.push( move( job ) );
+    }
+    ready.notify_one();
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Body of each worker thread. Takes jobs off the queue
+ * until the pool is stopping and the queue is empty.
+ *
+ * @params  none
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void Executor::run()
+{
+    while ( true )
+    {
+        function<void()> job;
+        {
+            unique_lock<mutex> guard( lock );
+            ready.wait( guard, [this] { return stopping || !jobs.empty(); } );
+            if ( jobs.empty() )
+                return;
+            job = move( jobs.front() );
+            jobs.pop();
+        }
+        job();
+    }
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Returns the pool shared by all asynchronous
+ * operations, started on first use with one thread per core.
+ *
+ * @params  none
+ *
+ * @returns reference to the pool
+ *
+ * *****************************************************/
+static Executor& executor()
+{
+    static Executor pool( max( 1u, thread::hardware_concurrency() ) );
+
+    return pool;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplies two LargeInts on the worker pool. The
+ * operands are copied into the job, which only shares their lists, so the
+ * caller may change or destroy its own values while the job runs. The
+ * multiply kernel checks the token and reports progress between blocks of
+ * multiplier digits.
+ *
+ * @params[in]  a        - LargeInt multiplicand
+ * @params[in]  b        - LargeInt multiplier
+ * @params[in]  cancel   - token the caller can set to stop the job, may be
+ *                         nullptr
+ * @params[in]  progress - called on the worker thread with multiplier
+ *                         digits done, may be empty
+ *
+ * @returns future holding a * b, or OperationCancelled if the job was
+ *          cancelled
+ *
+ * *****************************************************/
+future<LargeInt> async_multiply( const LargeInt& a, const LargeInt& b, 
+    shared_ptr<CancelToken> cancel, ProgressFn progress )
+{
+    shared_ptr<promise<LargeInt>> result = make_shared<promise<LargeInt>>();
+    LargeInt lhs( a ), rhs( b );
+
+    executor().submit( [result, lhs, rhs, cancel, progress]
+    {
+        LargeInt product;
+
+        if ( multiply( lhs, rhs, product, cancel.get(), progress ) )
+            result->set_value( product );
+        else
+            result->set_exception( make_exception_ptr( OperationCancelled() ) );
+    } );
+
+    return result->get_future();
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Adds two LargeInts on the worker pool, so a sum can be
+ * queued behind other asynchronous operations it depends on.
+ *
+ * @params[in]  a - first LargeInt to be added
+ * @params[in]  b - second LargeInt to be added
+ *
+ * @returns future holding a + b
+ *
+ * *****************************************************/
+future<LargeInt> async_add( const LargeInt& a, const LargeInt& b )
+{
+    shared_ptr<promise<LargeInt>> result = make_shared<promise<LargeInt>>();
+    LargeInt lhs( a ), rhs( b );
+
+    executor().submit( [result, lhs, rhs]
+    {
+        result->set_value( lhs + rhs );
+    } );
+
+    return result->get_future();
+}
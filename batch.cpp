@@ -0,0 +1,377 @@
+/* @file
+ * @brief Batch calculator for the LargeInt class. Reads one expression per
+ * line, evaluates the lines on a pool of worker threads, and writes one
+ * result per line in input order.
+ *
+ * Usage: batch [-j threads] [file]
+ *
+ * Each line holds "A op B" where A and B are non-negative integers and op is
+ * one of + - * / % < > <= >= == !=. Spaces around op are optional. Arithmetic
+ * lines print the result, comparisons print 1 or 0, blank lines print a
+ * blank line and anything else, including division by zero, prints "error".
+ * Input comes from file, or from stdin if no file is given. Throughput of
+ * the lines that evaluated is reported on stderr when the input is
+ * exhausted.
+ * */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+#include "largeint.h"
+
+/*!
+* @brief number of lines read and evaluated together before writing results
+*/
+static const size_t BATCH_LINES = 65536;
+
+/*!
+* @brief Worker threads kept for the whole run. Each batch is handed to all
+* of them at once, and each worker takes every nth line of it, so no
+* locking is needed per line. The threads keep their available space lists
+* from one batch to the next.
+*/
+class BatchWorkers
+{
+    private:
+        vector<thread> workers;         /*!< threads evaluating lines */
+        const vector<string>* lines;    /*!< lines of the current batch */
+        vector<string>* results;        /*!< results of the current batch */
+        vector<size_t> evaluated;       /*!< lines evaluated per worker */
+        vector<size_t> digits;          /*!< operand digits per worker */
+        mutex lock;                     /*!< guards the fields below */
+        condition_variable started;     /*!< signalled for a new batch */
+        condition_variable finished;    /*!< signalled when a batch is done */
+        unsigned batch = 0;             /*!< number of batches handed out */
+        unsigned running = 0;           /*!< workers still on the batch */
+        bool stopping = false;          /*!< set when the workers exit */
+
+        void run( unsigned t );
+
+    public:
+        BatchWorkers( unsigned threads );
+        ~BatchWorkers();
+
+        void evaluateBatch( const vector<string>& lines, 
+            vector<string>& results, size_t& count, size_t& total );
+};
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Reads a run of decimal digits starting at pos, skipping
+ * any spaces before it and any leading zeros in it.
+ *
+ * @params[in]     line - expression line
+ * @params[in,out] pos  - position to start at, left after the digits
+ * @params[out]    num  - digits read, "0" if they were all zeros
+ *
+ * @returns true if at least one digit was read, false otherwise
+ *
+ * *****************************************************/
+static bool readNumber( const string& line, size_t& pos, string& num )
+{
+    size_t start;
+
+    while ( pos < line.size() && isspace( ( unsigned char ) line[pos] ) )
+        pos++;
+
+    start = pos;
+    while ( pos < line.size() && isdigit( ( unsigned char ) line[pos] ) )
+        pos++;
+
+    if ( pos == start )
+        return false;
+
+    //strip leading zeros, keeping at least one digit
+    while ( start < pos - 1 && line[start] == '0' )
+        start++;
+
+    num.assign( line, start, pos - start );
+    return true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Parses and evaluates one expression line.
+ *
+ * @params[in]  line   - expression line
+ * @params[out] result - text of the result, "error" if the line is
+ *                       malformed or divides by zero
+ * @params[out] digits - number of operand digits in the line, 0 unless it
+ *                       evaluated
+ *
+ * @returns true if the line evaluated, false if it was blank or an error
+ *
+ * *****************************************************/
+static bool evaluate( const string& line, string& result, size_t& digits )
+{
+    string a, b, op;
+    size_t pos = 0;
+
+    digits = 0;
+    result.clear();
+
+    //blank lines echo as blank lines
+    if ( line.find_first_not_of( " \t\r" ) == string::npos )
+        return false;
+
+    if ( !readNumber( line, pos, a ) )
+    {
+        result = "error";
+        return false;
+    }
+
+    while ( pos < line.size() && isspace( ( unsigned char ) line[pos] ) )
+        pos++;
+    while ( pos < line.size() && strchr( "+-*/%<>=!", line[pos] ) != nullptr )
+        op += line[pos++];
+
+    if ( !readNumber( line, pos, b ) || 
+        line.find_first_not_of( " \t\r", pos ) != string::npos )
+    {
+        result = "error";
+        return false;
+    }
+
+    LargeInt lhs( a ), rhs( b ), value;
+    ostringstream out;
+
+    //the library divides by zero quietly, giving 0 and lhs
+    if ( ( op == "/" || op == "%" ) && rhs.is_zero() )
+    {
+        result = "error";
+        return false;
+    }
+
+    if ( op == "+" )
+        value = lhs + rhs;
+    else if ( op == "-" )
+        value = lhs - rhs;
+    else if ( op == "*" )
+        value = lhs * rhs;
+    else if ( op == "/" )
+        value = lhs / rhs;
+    else if ( op == "%" )
+        value = lhs % rhs;
+    else if ( op == "<" )
+        value = ( lhs < rhs );
+    else if ( op == ">" )
+        value = ( lhs > rhs );
+    else if ( op == "<=" )
+        value = ( lhs <= rhs );
+    else if ( op == ">=" )
+        value = ( lhs >= rhs );
+    else if ( op == "==" )
+        value = ( lhs == rhs );
+    else if ( op == "!=" )
+        value = ( lhs != rhs );
+    else
+    {
+        result = "error";
+        return false;
+    }
+
+    out << value;
+    result = out.str();
+    digits = a.size() + b.size();
+    return true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Starts the worker threads, which wait for the first
+ * batch.
+ *
+ * @params[in]  threads - number of worker threads
+ *
+ * @returns none
+ *
+ * *****************************************************/
+BatchWorkers::BatchWorkers( unsigned threads ) : lines( nullptr ), 
+    results( nullptr ), evaluated( threads, 0 ), digits( threads, 0 )
+{
+    for ( unsigned t = 0; t < threads; t++ )
+        workers.emplace_back( &BatchWorkers::run, this, t );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Tells the idle workers to exit and joins them.
+ *
+ * @params  none
+ *
+ * @returns none
+ *
+ * *****************************************************/
+BatchWorkers::~BatchWorkers()
+{
+    {
+        lock_guard<mutex> guard( lock );
+        stopping = true;
+    }
+    started.notify_all();
+
+    for ( thread& worker : workers )
+        worker.join();
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Body of worker t. Waits for each new batch, evaluates
+ * every nth line of it starting at line t, and reports back.
+ *
+ * @params[in]  t - index of the worker
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void BatchWorkers::run( unsigned t )
+{
+    unsigned done = 0;
+
+    while ( true )
+    {
+        {
+            unique_lock<mutex> guard( lock );
+            started.wait( guard, [&] { return stopping || batch != done; } );
+            if ( stopping )
+                return;
+            done = batch;
+        }
+
+        size_t count, lineCount = 0, sum = 0;
+        for ( size_t i = t; i < lines->size(); i += workers.size() )
+        {
+            if ( evaluate( ( *lines )[i], ( *results )[i], count ) )
+                lineCount++;
+            sum += count;
+        }
+
+        {
+            lock_guard<mutex> guard( lock );
+            evaluated[t] = lineCount;
+            digits[t] = sum;
+            if ( --running == 0 )
+                finished.notify_one();
+        }
+    }
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Evaluates a batch of lines on the worker threads and
+ * waits for all of them to finish it.
+ *
+ * @params[in]  lines   - expression lines
+ * @params[out] results - result text for each line
+ * @params[out] count   - number of lines that evaluated
+ * @params[out] total   - number of operand digits in those lines
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void BatchWorkers::evaluateBatch( const vector<string>& lines, 
+    vector<string>& results, size_t& count, size_t& total )
+{
+    count = 0;
+    total = 0;
+
+    results.resize( lines.size() );
+    {
+        unique_lock<mutex> guard( lock );
+        this->lines = &lines;
+        this->results = &results;
+        running = workers.size();
+        batch++;
+        started.notify_all();
+        finished.wait( guard, [this] { return running == 0; } );
+    }
+
+    for ( unsigned t = 0; t < workers.size(); t++ )
+    {
+        count += evaluated[t];
+        total += digits[t];
+    }
+}
+
+//-----------------------------------------------------------------------------
+//          ***** main program for the batch calculator *****
+//-----------------------------------------------------------------------------
+
+int main( int argc, char *argv[] )
+{
+    unsigned threads = max( 1u, thread::hardware_concurrency() );
+    ifstream file;
+    istream* in = &cin;
+    int arg = 1;
+
+    // command line options
+    if ( arg + 1 < argc && string( argv[arg] ) == "-j" )
+    {
+        threads = max( 1, atoi( argv[arg + 1] ) );
+        arg += 2;
+    }
+    if ( arg < argc )
+    {
+        file.open( argv[arg] );
+        if ( !file )
+        {
+            cerr << "batch: cannot open " << argv[arg] << endl;
+            return 1;
+        }
+        in = &file;
+    }
+
+    ios::sync_with_stdio( false );
+
+    vector<string> lines, results;
+    size_t expressions = 0, digits = 0, count, total;
+    string line;
+    auto start = chrono::steady_clock::now();
+    BatchWorkers workers( threads );
+
+    // read, evaluate and write one batch at a time
+    while ( in->good() )
+    {
+        lines.clear();
+        while ( lines.size() < BATCH_LINES && getline( *in, line ) )
+            lines.push_back( line );
+        if ( lines.empty() )
+            break;
+
+        workers.evaluateBatch( lines, results, count, total );
+        expressions += count;
+        digits += total;
+
+        for ( const string& result : results )
+            cout << result << '\n';
+    }
+    cout.flush();
+
+    // throughput report
+    double seconds = chrono::duration<double>( 
+        chrono::steady_clock::now() - start ).count();
+    if ( seconds <= 0 )
+        seconds = 1e-9;
+
+    cerr << expressions << " expressions, " << digits << " digits in " 
+         << seconds << " s (" << expressions / seconds << " expressions/s, " 
+         << digits / seconds << " digits/s) on " << threads << " threads" 
+         << endl;
+
+    return 0;
+}
@@ -4,7 +4,8 @@
  * ~Polynomial(), Polynomial( const Polynomial& ), print(), Polynomial( string ),
  * Polynomial( const Polynomial& ), freePoly(), operator=( const LargeInt& ),
  * operator*=( const LargeInt& ), operator>>( istream&, LargeInt& ), and all 
- * of the overloaded comparison implemtations.
+ * of the overloaded comparison implemtations. release(), which frees a
+ * list for freePoly() and unshare(), was added later.
  * */
 
 #include "largeint.h"
@@ -16,6 +17,11 @@ ListNode* asl_new( int coeff = 0, int power = 0, ListNode* next = nullptr,
         ListNode* prev = nullptr );
 void asl_delete( ListNode* delnode );
 
+/*!
+* @brief reference count shared by every list in static storage
+*/
+atomic<int> Polynomial::immortal( 1 );
+
 
 /********************************************************
  * @author Chezka Gaddi
@@ -57,26 +63,22 @@ Polynomial::Polynomial ( const Polynomial& poly  )
  * @author Chezka Gaddi
  *
  * @par Description: 
- * print() traverses through all the nodes of the
- * Polynomial and prints out contents. Can only be called
- * by class objects.
+ * print() formats all the nodes of the Polynomial into
+ * one buffer and writes it to the stream at once. Can
+ * only be called by class objects.
  *
- * @params  none
+ * @params[in]  out - ostream to print to (cout by default)
  *
  * @returns none
  *
  * *****************************************************/
-void Polynomial::print() const
+void Polynomial::print( ostream& out ) const
 {
-    ListNode* temp = head;
+    //formats all digits of the LargeInt, then prints them
+    string text( head -> power + 1, '0' );
 
-    //prints all digits of the LargeInt
-    while ( temp != nullptr )
-    {
-        cout << temp -> coeff;
-
-        temp = temp -> next;
-    }
+    toChars( &text[0] );
+    out.write( text.data(), text.size() );
 }
 
 
@@ -96,7 +98,7 @@ void Polynomial::print() const
 Polynomial::Polynomial ( string value )
 {
     //handles first node
-    tail = asl_new ( atoi( &value.back() ) );
+    tail = asl_new ( value.back() - '0' );
     value.pop_back();
 
     ListNode* curr = tail;
@@ -106,7 +108,7 @@ Polynomial::Polynomial ( string value )
     //integer converted characters
     while ( !value.empty() )
     {
-        curr ->prev = asl_new( atoi( &value.back()), pow, curr );
+        curr ->prev = asl_new( value.back() - '0', pow, curr );
         value.pop_back();
         pow++;
         curr = curr ->prev;
@@ -121,8 +123,12 @@ Polynomial::Polynomial ( string value )
  *
  * @par Description: 
  * copyPoly frees up the polynomial that made the
- * function call and creates a hard copy of the data
- * passed in by poly. 
+ * function call and shares the list of poly with it.
+ * The first copy gives the list a reference count,
+ * installed atomically so that several threads can copy
+ * the same polynomial at once. The nodes are only
+ * duplicated by unshare() when one side writes to them.
+ * Lists in static storage keep the immortal count.
  *
  * @params[in]  poly - polynomial to be copied
  *
@@ -133,55 +139,57 @@ void Polynomial::copyPoly( const Polynomial & poly )
 {
     freePoly();
 
-    //handles first digit of integer
-    head = asl_new( poly.head ->coeff, poly.head ->power );
+    atomic<int>* count = poly.refs.load( memory_order_acquire );
 
-    //handles one digit integers
-    if ( poly.head == poly.tail )
+    //first copy of the list, give it a reference count
+    if ( count == nullptr )
     {
-        tail = head;
-        return;
-    }
-
-    //declaration of traversal nodes
-    ListNode* curr = head;
-    ListNode* curr2 = poly.head ->next;
+        atomic<int>* fresh = new atomic<int>( 1 );
 
-    //copy contents of LargeInt p to *this
-    while ( curr2 != nullptr )
-    {
-        curr ->next = asl_new( curr2 ->coeff, curr2 ->power, nullptr, curr );
-        curr = curr ->next;
-        curr2 = curr2 ->next;
+        if ( poly.refs.compare_exchange_strong( count, fresh ) )
+            count = fresh;
+        else
+            delete fresh;
     }
 
-    //assigns tail to last digit of integer
-    tail = curr;
+    //lists in static storage are not counted
+    if ( count != &immortal )
+        count ->fetch_add( 1, memory_order_relaxed );
+    refs.store( count, memory_order_relaxed );
+    head = poly.head;
+    tail = poly.tail;
 }
 
 
 /********************************************************
- * @author Chezka Gaddi
+ * @author agent
  *
- * @par Description: 
- * freePoly traverses through the polynomial and calls
- * asl_delete to push nodes onto the asl stack and
- * remove them from the polynomial that called the
- * function.  
+ * @par Description: Drops one hold on a list. A list that is not shared
+ * (count is nullptr) or whose last other owner has let go has its nodes
+ * pushed onto the asl stack; a list in static storage is never freed.
  *
- * @params  none
+ * @params[in]  first - head node of the list
+ * @params[in]  last  - tail node of the list
+ * @params[in]  count - reference count of the list, may be nullptr
  *
  * @returns none
  *
  * *****************************************************/
-void Polynomial::freePoly()
+void Polynomial::release( ListNode* first, ListNode* last, 
+    atomic<int>* count )
 {
-    //handles empty polynomials
-    if ( head == nullptr && tail == nullptr )
+    //drop this owner, leaving the nodes to the others
+    if ( count == &immortal )
         return;
+    if ( count != nullptr )
+    {
+        if ( count ->fetch_sub( 1, memory_order_acq_rel ) != 1 )
+            return;
+        delete count;
+    }
 
     //declaration of traversal node pointer
-    ListNode* temp = head ->next;
+    ListNode* temp = first ->next;
     
     //deletes all nodes
     while ( temp != nullptr )
@@ -190,7 +198,32 @@ void Polynomial::freePoly()
         temp = temp ->next;
     }
 
-    asl_delete( head );
+    asl_delete( last );
+}
+
+
+/********************************************************
+ * @author Chezka Gaddi
+ *
+ * @par Description: 
+ * freePoly releases the list of the polynomial that
+ * called the function and leaves it empty. A shared
+ * list is only freed by its last owner, and a list in
+ * static storage never is.
+ *
+ * @params  none
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void Polynomial::freePoly()
+{
+    //handles empty polynomials
+    if ( head == nullptr && tail == nullptr )
+        return;
+
+    release( head, tail, refs.exchange( nullptr, memory_order_relaxed ) );
+    head = tail = nullptr;
 }
 
 
@@ -210,7 +243,8 @@ void Polynomial::freePoly()
 const LargeInt& LargeInt::operator=( const LargeInt& integer )
 {
     //makes copy of LargeInt and returns current object
-    copyPoly ( integer );
+    if ( this != &integer )
+        copyPoly ( integer );
     return *this;
 }
 
@@ -248,107 +282,22 @@ istream & operator>>( istream &in, LargeInt& p )
  * @author Chezka Gaddi
  *
  * @par Description: 
- * Overloading the * operator takes in two LargeInt objects to be multiplied.
- * and assigns pointers to traverse through each. It then creates two
- * temporary LargeInts to record current factor and a running sum. Starting
- * at the 0th power of the multiplier, it creates a factor and adds it to the
- * running sum of all the factors.
+ * Overloading the * operator takes in two LargeInt objects to be multiplied
+ * and hands them to the multiply() kernel, which adds each digit product
+ * into the column for its power and resolves all the carries at the end.
  *
  * @params[in]  lhs - LargeInt multiplicand
  * @params[in]  rhs - LargeInt multiplier
  *
- * @returns sumptr - pointer the the LargeInt holding the sum of all factors
+ * @returns product - the LargeInt holding lhs * rhs
  *
  * *****************************************************/
-const LargeInt& operator*( const LargeInt& lhs, const LargeInt& rhs )
+LargeInt operator*( const LargeInt& lhs, const LargeInt& rhs )
 {
-    //declaration of traversal nodes
-    ListNode *cand = nullptr;
-    ListNode *plier = rhs.tail;
-
-    //declaration of temporary LargeInt and supporting variables to calculate
-    //factors and addends
-    LargeInt* factor = new ( nothrow ) LargeInt;
-    LargeInt* sum = new ( nothrow ) LargeInt;
-    ListNode* fact = nullptr;
-    int carry, num, pow;
-
-    //loops through and one digit of the multiplier at a time
-    while ( plier != nullptr )
-    {
-        //initialize new factor
-        carry = 0;
-        cand = lhs.tail;
-        pow = plier ->power;
-
-        factor ->tail = asl_new();
-        fact = factor ->tail;
-
-        //if multiplier is not the last digit, create nodes with coefficient 0
-        //to offset addend to correct position
-        if ( pow != 0 )
-        {
-            for ( int i = 1; i < pow; i++ )
-            {
-                fact ->prev= asl_new( 0, i, fact );
-                fact = fact ->prev;
-            }
-        }
-
-        else
-        {
-            //calculate product
-            num = plier -> coeff * cand -> coeff + carry;
-
-            //calculate overflow to next product
-            carry = num / 10;
-
-
-            //calculate single digit to store as coefficient
-            fact -> coeff = num - ( carry * 10 );
-
-            //interate to next digit
-            pow++;
-            cand = cand -> prev;
-        }
-    
-        //calculate products of each digit of the multicand
-        while ( cand != nullptr )
-        {
-            //create product of the multiplier with each of the multicand's
-            //digits and store into factor LargeInt
-            num = plier -> coeff * cand -> coeff + carry;
-            carry = num / 10;
-            num = num - ( carry * 10 );
-
-            fact -> prev = asl_new( num, pow, fact );
-
-            fact = fact -> prev;
-            pow++;
-            cand = cand -> prev;
-        }
-
-        //create new node for the last carry of the factor
-        if ( carry != 0 )
-        {
-            fact ->prev = asl_new( carry, pow, fact );
-            fact = fact ->prev;
-        }
-    
-        factor ->head = fact;
-
-        //update sum
-        *sum = *sum + *factor;
-
-        factor ->freePoly();
-
-        //iterate to next digit of the multiplier
-        plier = plier -> prev;
-    }
+    LargeInt product;
 
-    //create new object to pass LargeInt back to main function
-    LargeInt &sumptr = *sum;
-    return sumptr;
+    multiply( lhs, rhs, product );
+    return product;
 }
 
 
@@ -0,0 +1,452 @@
+/* @file
+ * @brief This file contains the DiskInt class, an unsigned integer kept in
+ * a file of digits: constructors, to_largeint, compare, add, multiply and
+ * operator<<.
+ * */
+#include "largeint.h"
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+
+/*!
+* @brief digits read or written at a time when streaming over a file
+*/
+static const size_t DISK_CHUNK = 1 << 20;
+
+/*!
+* @brief digits per block of the blocked multiplication; its working memory
+* is two digit blocks and 2 * DISK_BLOCK column sums
+*/
+static const size_t DISK_BLOCK = 1 << 14;
+
+
+/*!
+* @brief Writes digits to a new digit file, least significant first. Zeros
+* are held back until a nonzero digit follows them, so the file never ends
+* in leading zeros. The file is written beside its final path and renamed
+* over it once complete.
+*/
+class DigitWriter
+{
+    private:
+        string file;                /*!< final path of the digit file */
+        ofstream out;               /*!< temporary file being written */
+        vector<char> buf;           /*!< digits waiting to be written */
+        uint64_t zeros = 0;         /*!< zeros held back */
+        uint64_t written = 0;       /*!< digits put in the file */
+
+        void flush();
+
+    public:
+        DigitWriter( const string& path );
+
+        void put( int digit );
+        bool finish( uint64_t& length );
+};
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Opens the temporary file for a new digit file.
+ *
+ * @params[in]  path - final path of the digit file
+ *
+ * @returns none
+ *
+ * *****************************************************/
+DigitWriter::DigitWriter( const string& path ) : file( path ),
+    out( path + ".tmp", ios::binary | ios::trunc )
+{
+    buf.reserve( DISK_CHUNK );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Writes the buffered digits to the file.
+ *
+ * @params  none
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void DigitWriter::flush()
+{
+    out.write( buf.data(), buf.size() );
+    written += buf.size();
+    buf.clear();
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Adds the next more significant digit.
+ *
+ * @params[in]  digit - digit from 0 to 9
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void DigitWriter::put( int digit )
+{
+    if ( digit == 0 )
+    {
+        zeros++;
+        return;
+    }
+
+    //the held back zeros are not leading zeros after all
+    for ( ; zeros > 0; zeros-- )
+    {
+        buf.push_back( 0 );
+        if ( buf.size() == DISK_CHUNK )
+            flush();
+    }
+
+    buf.push_back( digit );
+    if ( buf.size() == DISK_CHUNK )
+        flush();
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Writes the last digits, dropping the held back zeros
+ * (a number with no nonzero digit is written as a single 0), and renames
+ * the file into place. If anything failed the temporary file is removed
+ * and the file at path is left as it was.
+ *
+ * @params[out] length - number of digits in the file, set only on success
+ *
+ * @returns true if the file was written and renamed
+ *
+ * *****************************************************/
+bool DigitWriter::finish( uint64_t& length )
+{
+    string temp = file + ".tmp";
+
+    if ( written == 0 && buf.empty() )
+        buf.push_back( 0 );
+    flush();
+    out.close();
+
+    if ( !out || rename( temp.c_str(), file.c_str() ) != 0 )
+    {
+        remove( temp.c_str() );
+        return false;
+    }
+
+    length = written;
+    return true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Reads buf.size() digits of a digit file starting at
+ * power pos. Powers past the end of the number read as 0.
+ *
+ * @params[in]  in  - open digit file
+ * @params[in]  len - number of digits in the file
+ * @params[in]  pos - power of the first digit to read
+ * @params[out] buf - digits read
+ *
+ * @returns number of digits read from the file
+ *
+ * *****************************************************/
+static size_t readDigits( ifstream& in, uint64_t len, uint64_t pos,
+    vector<char>& buf )
+{
+    size_t count = 0;
+
+    if ( pos < len )
+    {
+        count = min<uint64_t>( buf.size(), len - pos );
+        in.clear();
+        in.seekg( pos );
+        in.read( buf.data(), count );
+    }
+    fill( buf.begin() + count, buf.end(), 0 );
+    return count;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Opens an existing digit file and finds its length.
+ * The file is read through once a chunk at a time to check that every byte
+ * is a digit from 0 to 9 and that the number has no leading zero. Nothing
+ * is written: a missing, unreadable, empty or malformed file leaves the
+ * DiskInt not good, with no digits.
+ *
+ * @params[in]  path - path of the digit file
+ *
+ * @returns none
+ *
+ * *****************************************************/
+DiskInt::DiskInt( const string& path ) : file( path ), len( 0 ), ok( false )
+{
+    ifstream in( path, ios::binary | ios::ate );
+    streamoff size = in ? streamoff( in.tellg() ) : 0;
+    vector<char> buf( DISK_CHUNK );
+
+    if ( size <= 0 )
+        return;
+
+    for ( uint64_t pos = 0; pos < uint64_t( size ); pos += DISK_CHUNK )
+    {
+        size_t count = readDigits( in, size, pos, buf );
+
+        if ( !in )
+            return;
+        for ( size_t i = 0; i < count; i++ )
+            if ( buf[i] < 0 || buf[i] > 9 )
+                return;
+    }
+
+    //the last byte read is the most significant digit
+    if ( size > 1 && buf[( size - 1 ) % DISK_CHUNK] == 0 )
+        return;
+
+    len = size;
+    ok = true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Writes the digits of a LargeInt to a new digit file.
+ * If it cannot be written the DiskInt is not good.
+ *
+ * @params[in]  path  - path of the digit file
+ * @params[in]  value - number to store
+ *
+ * @returns none
+ *
+ * *****************************************************/
+DiskInt::DiskInt( const string& path, const LargeInt& value ) : file( path ),
+    len( 0 ), ok( false )
+{
+    DigitWriter out( file );
+
+    for ( ListNode* curr = value.tail; curr != nullptr; curr = curr->prev )
+        out.put( curr->coeff );
+    ok = out.finish( len );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Reads the whole number into a LargeInt. The caller is
+ * responsible for the number fitting in memory.
+ *
+ * @params  none
+ *
+ * @returns the number as a LargeInt
+ *
+ * *****************************************************/
+LargeInt DiskInt::to_largeint() const
+{
+    ifstream in( file, ios::binary );
+    vector<char> buf( len );
+    vector<int> num( len );
+    LargeInt result;
+
+    if ( !ok )
+        return result;
+
+    readDigits( in, len, 0, buf );
+    for ( uint64_t i = 0; i < len; i++ )
+        num[i] = buf[i];
+
+    result.fromDigits( num );
+    return result;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Compares two DiskInts. Neither file holds leading
+ * zeros, so a longer number is larger; equal lengths are compared chunk by
+ * chunk from the most significant end until the digits differ.
+ *
+ * @params[in]  lhs - left operand
+ * @params[in]  rhs - right operand
+ *
+ * @returns -1, 0 or 1 as lhs is less than, equal to or greater than rhs
+ *
+ * *****************************************************/
+int compare( const DiskInt& lhs, const DiskInt& rhs )
+{
+    if ( lhs.len != rhs.len )
+        return ( lhs.len < rhs.len ) ? -1 : 1;
+
+    ifstream left( lhs.file, ios::binary ), right( rhs.file, ios::binary );
+    vector<char> a( DISK_CHUNK ), b( DISK_CHUNK );
+    uint64_t end = lhs.len;
+
+    while ( end > 0 )
+    {
+        uint64_t pos = ( end > DISK_CHUNK ) ? end - DISK_CHUNK : 0;
+
+        readDigits( left, lhs.len, pos, a );
+        readDigits( right, rhs.len, pos, b );
+        for ( size_t i = end - pos; i-- > 0; )
+            if ( a[i] != b[i] )
+                return ( a[i] < b[i] ) ? -1 : 1;
+        end = pos;
+    }
+    return 0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Adds two DiskInts a chunk at a time from the least
+ * significant end, carrying between chunks.
+ *
+ * @params[in]  lhs    - left operand
+ * @params[in]  rhs    - right operand
+ * @params[out] result - lhs + rhs
+ *
+ * @returns true if the sum was written
+ *
+ * *****************************************************/
+bool add( const DiskInt& lhs, const DiskInt& rhs, DiskInt& result )
+{
+    ifstream left( lhs.file, ios::binary ), right( rhs.file, ios::binary );
+    vector<char> a( DISK_CHUNK ), b( DISK_CHUNK );
+    uint64_t len = max( lhs.len, rhs.len );
+    int carry = 0;
+
+    if ( !lhs.ok || !rhs.ok )
+        return false;
+
+    DigitWriter out( result.file );
+    for ( uint64_t pos = 0; pos < len; pos += DISK_CHUNK )
+    {
+        readDigits( left, lhs.len, pos, a );
+        readDigits( right, rhs.len, pos, b );
+
+        size_t count = min<uint64_t>( DISK_CHUNK, len - pos );
+        for ( size_t i = 0; i < count; i++ )
+        {
+            int sum = a[i] + b[i] + carry;
+            carry = sum / 10;
+            out.put( sum % 10 );
+        }
+    }
+    out.put( carry );
+
+    left.close();
+    right.close();
+    if ( !out.finish( result.len ) )
+        return false;
+    result.ok = true;
+    return true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplies two DiskInts by blocks of DISK_BLOCK
+ * digits. Output block k collects the products of the operand blocks i and
+ * k - i into column sums covering two blocks. Its lower half is carried and
+ * written, and its upper half starts the columns of block k + 1. Only two
+ * operand blocks and the column sums are in memory at once.
+ *
+ * @params[in]  lhs    - left operand
+ * @params[in]  rhs    - right operand
+ * @params[out] result - lhs * rhs
+ *
+ * @returns true if the product was written
+ *
+ * *****************************************************/
+bool multiply( const DiskInt& lhs, const DiskInt& rhs, DiskInt& result )
+{
+    ifstream left( lhs.file, ios::binary ), right( rhs.file, ios::binary );
+    vector<char> a( DISK_BLOCK ), b( DISK_BLOCK );
+    vector<uint64_t> cols( 2 * DISK_BLOCK, 0 );
+    uint64_t na = ( lhs.len + DISK_BLOCK - 1 ) / DISK_BLOCK;
+    uint64_t nb = ( rhs.len + DISK_BLOCK - 1 ) / DISK_BLOCK;
+    uint64_t carry = 0;
+
+    if ( !lhs.ok || !rhs.ok )
+        return false;
+
+    DigitWriter out( result.file );
+    for ( uint64_t k = 0; k < na + nb; k++ )
+    {
+        //products of the operand block pairs landing on block k
+        uint64_t first = ( k >= nb ) ? k - nb + 1 : 0;
+        for ( uint64_t i = first; i <= k && i < na; i++ )
+        {
+            size_t sa = readDigits( left, lhs.len, i * DISK_BLOCK, a );
+            size_t sb = readDigits( right, rhs.len, ( k - i ) * DISK_BLOCK, b );
+
+            for ( size_t x = 0; x < sa; x++ )
+            {
+                if ( a[x] == 0 )
+                    continue;
+                for ( size_t y = 0; y < sb; y++ )
+                    cols[x + y] += a[x] * b[y];
+            }
+        }
+
+        //carry through and write the lower half
+        for ( size_t c = 0; c < DISK_BLOCK; c++ )
+        {
+            carry += cols[c];
+            out.put( carry % 10 );
+            carry /= 10;
+        }
+
+        //the upper half becomes the lower half of block k + 1
+        copy( cols.begin() + DISK_BLOCK, cols.end(), cols.begin() );
+        fill( cols.begin() + DISK_BLOCK, cols.end(), 0 );
+    }
+
+    for ( ; carry > 0; carry /= 10 )
+        out.put( carry % 10 );
+
+    left.close();
+    right.close();
+    if ( !out.finish( result.len ) )
+        return false;
+    result.ok = true;
+    return true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Writes the decimal digits of a DiskInt, reading the
+ * file a chunk at a time from the most significant end.
+ *
+ * @params[in]  out   - ostream to write to
+ * @params[in]  value - DiskInt to write
+ *
+ * @returns out - ostream
+ *
+ * *****************************************************/
+ostream& operator<<( ostream& out, const DiskInt& value )
+{
+    ifstream in( value.file, ios::binary );
+    vector<char> buf( DISK_CHUNK );
+    uint64_t end = value.len;
+
+    while ( end > 0 )
+    {
+        uint64_t pos = ( end > DISK_CHUNK ) ? end - DISK_CHUNK : 0;
+        size_t count = end - pos;
+
+        readDigits( in, value.len, pos, buf );
+        reverse( buf.begin(), buf.begin() + count );
+        for ( size_t i = 0; i < count; i++ )
+            buf[i] += '0';
+        out.write( buf.data(), count );
+        end = pos;
+    }
+    return out;
+}
@@ -29,6 +29,13 @@ LargeInt operator functions +, *, >>, <<.
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
 
 using namespace std;
 
@@ -41,8 +48,9 @@ struct ListNode
 {
     int coeff, power;
     ListNode *next, *prev;
-    // constructor makes node initialization easier
-    ListNode( int c = 0, int p = 0, ListNode *n = nullptr, 
+    // constructor makes node initialization easier; constexpr so that the
+    // nodes of LargeInt literals are built at compile time
+    constexpr ListNode( int c = 0, int p = 0, ListNode *n = nullptr, 
     ListNode *pr = nullptr ) : coeff( c ), power( p ), next( n ), prev( pr ) { }
 };
 
@@ -58,10 +66,30 @@ class Polynomial
         // data members
         ListNode* head = nullptr; /*!< Pointer to beginning of number in LL*/
         ListNode* tail = nullptr; /*!< Pointer to end of number in LL*/      
+        /*! Count of Polynomials sharing the LL, nullptr while not shared */
+        mutable atomic<atomic<int>*> refs { nullptr };
+        /*! refs of lists in static storage, which are never freed */
+        static atomic<int> immortal;
+
+        // shares a list in static storage, see LargeIntConst
+        Polynomial( ListNode* first, ListNode* last ) : head( first ), 
+            tail( last ), refs { &immortal } { }
 
         // member functions that are only called by other member functions
         void copyPoly( const Polynomial & );
         void freePoly();
+        void unshare();                         // copy the LL before writing to it
+        void stripZeros();                      // remove leading zero nodes
+        // drop one hold on a list, freeing it once no owner is left
+        static void release( ListNode* first, ListNode* last, 
+            atomic<int>* count );
+
+        // conversion to and from a digit array, least significant digit first
+        void toDigits( vector<int> & ) const;
+        void fromDigits( const vector<int> & );
+        // decimal characters, most significant first, at first; writes
+        // head->power + 1 characters and returns the end of them
+        char* toChars( char* first ) const;
 
     public:                   // public class interface
         // constructor and destructor functions
@@ -71,7 +99,33 @@ class Polynomial
         ~Polynomial();                          // destructor: deallocate linked list nodes
 
         // print() method (for debugging purposes)
-        void print() const;
+        void print( ostream& out = cout ) const;
+};
+
+//-----------------------------------------------------------------------------
+
+class CancelToken;
+
+/*!
+* @brief Callback told how much of a long operation is done, as a count of
+* finished steps out of a total
+*/
+typedef function<void( size_t done, size_t total )> ProgressFn;
+
+//-----------------------------------------------------------------------------
+
+/*!
+* @brief Compile time constant LargeInt, made by the _li literal. It points
+* at a digit list built by the compiler in static storage, so turning it
+* into a LargeInt needs no parsing and no allocation
+*/
+struct LargeIntConst
+{
+    ListNode* head;            /*!< most significant node */
+    ListNode* tail;            /*!< least significant node */
+
+    constexpr LargeIntConst( ListNode* first, ListNode* last ) : 
+        head( first ), tail( last ) { }
 };
 
 //-----------------------------------------------------------------------------
@@ -91,18 +145,58 @@ class LargeInt : public Polynomial
         LargeInt( unsigned value = 0 ) : Polynomial( value ) { }
         LargeInt( string value ) : Polynomial( value ) { }
         LargeInt( const LargeInt& Q ) : Polynomial( Q ) { }
+        // shares the static list of a literal, copying it only if written
+        LargeInt( const LargeIntConst& Q ) : Polynomial( Q.head, Q.tail ) { }
 
-        // addition and multiplication operators: P + Q, P * Q
-        // use friend functions to allow P + 43, 43 + P, etc.
-        friend const LargeInt& operator+( const LargeInt&, const LargeInt& );
-        friend const LargeInt& operator*( const LargeInt&, const LargeInt& );
+        // addition, subtraction and multiplication operators: P + Q, P - Q,
+        // P * Q. use friend functions to allow P + 43, 43 + P, etc.
+        // LargeInt is unsigned, so P - Q is 0 whenever P < Q
+        friend LargeInt operator+( const LargeInt&, const LargeInt& );
+        friend LargeInt operator-( const LargeInt&, const LargeInt& );
+        friend LargeInt operator*( const LargeInt&, const LargeInt& );
 
-        // assignment operators: P = Q, P += Q, P *= Q
+        // multiplication kernel behind operator*. stops early and returns
+        // false if cancel is set; progress is told the multiplier digits
+        // done as the work proceeds
+        friend bool multiply( const LargeInt&, const LargeInt&, LargeInt&, 
+            const CancelToken*, const ProgressFn& );
+
+        // machine integer operands skip building a LargeInt for them
+        friend LargeInt operator+( const LargeInt&, uint64_t );
+        friend LargeInt operator+( uint64_t, const LargeInt& );
+        friend LargeInt operator-( const LargeInt&, uint64_t );
+        friend LargeInt operator*( const LargeInt&, uint64_t );
+        friend LargeInt operator*( uint64_t, const LargeInt& );
+
+        // division operators: P / Q, P % Q, and both at once with divmod
+        // dividing by 0 gives a quotient of 0 and a remainder of P
+        friend LargeInt operator/( const LargeInt&, const LargeInt& );
+        friend LargeInt operator%( const LargeInt&, const LargeInt& );
+        friend void divmod( const LargeInt&, const LargeInt&, LargeInt&, 
+            LargeInt& );
+
+        // assignment operators: P = Q, P += Q, P -= Q, P *= Q, P /= Q, P %= Q
         
         
         const LargeInt& operator=( const LargeInt& );
         const LargeInt& operator+=( const LargeInt& );
+        const LargeInt& operator-=( const LargeInt& );
         const LargeInt& operator*=( const LargeInt& );
+        const LargeInt& operator/=( const LargeInt& );
+        const LargeInt& operator%=( const LargeInt& );
+
+        // machine integer operations, done in place in one pass over the
+        // digits (increments touch only the digits that carry):
+        // ++P, P++, --P, P--, P += n, P -= n, P *= n, and divmod_small( n )
+        // which divides P by n and returns the remainder
+        const LargeInt& operator++();
+        LargeInt operator++( int );
+        const LargeInt& operator--();
+        LargeInt operator--( int );
+        const LargeInt& operator+=( uint64_t );
+        const LargeInt& operator-=( uint64_t );
+        const LargeInt& operator*=( uint64_t );
+        uint64_t divmod_small( uint64_t );
 
         // relational comparison operators: P == Q, P < Q, etc.
         // use friend functions to allow P == 43, 43 == P, etc.
@@ -114,15 +208,395 @@ class LargeInt : public Polynomial
         friend bool operator<( const LargeInt&, const LargeInt& );
         friend bool operator>( const LargeInt&, const LargeInt& );
         
+        // decimal shift operations, done in place on the digit list:
+        // P * 10^k, P / 10^k, P mod 10^k
+        const LargeInt& shift_left10( unsigned k );
+        const LargeInt& shift_right10( unsigned k );
+        const LargeInt& mod_pow10( unsigned k );
+
+        // digit extraction: coefficient of 10^i, and the digits with powers
+        // i through j - 1 as a LargeInt
+        int digit( unsigned i ) const;
+        LargeInt digits( unsigned i, unsigned j ) const;
+
+        // number of decimal digits, test for zero, and value as a machine
+        // integer (only meaningful when length() <= 19)
+        unsigned length() const { return head->power + 1; }
+        bool is_zero() const { return head == tail && head->coeff == 0; }
+        uint64_t to_uint64() const;
+
+        // first n digits (n <= 19) as a machine integer, zero padded on the
+        // right when the number is shorter, and a hash of all the digits
+        uint64_t leading( unsigned n ) const;
+        size_t hash() const;
+
+        // exchanges the digit lists of two LargeInts without copying them
+        void swap( LargeInt& );
+
         // input/output operators: cin >> P, cout << P
         friend istream & operator>>( istream &, LargeInt& );
         friend ostream & operator<<( ostream &, const LargeInt& );
+
+        // formats the decimal digits into [first, last) without a null.
+        // returns the end of the digits, or nullptr if they do not fit
+        friend char* to_chars( char* first, char* last, const LargeInt& );
+
+        // converts to and from the digit files of DiskInt, and the sparse
+        // lists of SparseInt
+        friend class DiskInt;
+        friend class SparseInt;
         
         
 //-------------------------------------
         
 };
 
+//-----------------------------------------------------------------------------
+
+// algorithm crossover points in digits, starting at the values in tuning.h
+// and adjustable at run time: multiply switches from schoolbook to
+// Karatsuba at karatsuba_digits, and ModContext from division to Barrett
+// reduction at barrett_digits
+extern unsigned karatsuba_digits;
+extern unsigned barrett_digits;
+
+// formatting into a buffer, see LargeInt
+char* to_chars( char* first, char* last, const LargeInt& value );
+
+// multiplication kernel, see LargeInt
+bool multiply( const LargeInt& a, const LargeInt& b, LargeInt& product, 
+    const CancelToken* cancel = nullptr, const ProgressFn& progress = nullptr );
+
+// the arithmetic, comparison and output operators, see LargeInt. declared
+// here too so that operands which only convert to LargeInt find them, such
+// as literals in 5_li + 7_li or 5_li * 3
+LargeInt operator+( const LargeInt&, const LargeInt& );
+LargeInt operator-( const LargeInt&, const LargeInt& );
+LargeInt operator*( const LargeInt&, const LargeInt& );
+LargeInt operator/( const LargeInt&, const LargeInt& );
+LargeInt operator%( const LargeInt&, const LargeInt& );
+LargeInt operator+( const LargeInt&, uint64_t );
+LargeInt operator+( uint64_t, const LargeInt& );
+LargeInt operator-( const LargeInt&, uint64_t );
+LargeInt operator*( const LargeInt&, uint64_t );
+LargeInt operator*( uint64_t, const LargeInt& );
+bool operator==( const LargeInt&, const LargeInt& );
+bool operator!=( const LargeInt&, const LargeInt& );
+bool operator<=( const LargeInt&, const LargeInt& );
+bool operator>=( const LargeInt&, const LargeInt& );
+bool operator<( const LargeInt&, const LargeInt& );
+bool operator>( const LargeInt&, const LargeInt& );
+ostream& operator<<( ostream&, const LargeInt& );
+
+// number theoretic functions on LargeInt operands
+LargeInt gcd( const LargeInt&, const LargeInt& );
+LargeInt lcm( const LargeInt&, const LargeInt& );
+
+// returns g = gcd( a, b ) and sets x, y so that a * x - b * y == g (a != 0)
+LargeInt extended_gcd( const LargeInt& a, const LargeInt& b, LargeInt& x, 
+    LargeInt& y );
+
+// sets inv so that a * inv == 1 (mod m), returns false if no inverse exists
+bool modinv( const LargeInt& a, const LargeInt& m, LargeInt& inv );
+
+// integer roots: floor( x^(1/2) ), floor( x^(1/n) ) for n >= 1, and whether
+// x == r^n for some r and some n >= 2
+LargeInt isqrt( const LargeInt& x );
+LargeInt iroot( const LargeInt& x, unsigned n );
+bool is_perfect_power( const LargeInt& x );
+
+//-----------------------------------------------------------------------------
+
+// index list 0..N-1 for building literal digit lists, as C++11 has none.
+// built from two halves so that the nesting grows with log2( N ), not N
+template <size_t... I> struct IndexList { typedef IndexList type; };
+template <typename Lo, typename Hi> struct JoinIndexList;
+template <size_t... I, size_t... J> 
+struct JoinIndexList<IndexList<I...>, IndexList<J...>> 
+    : IndexList<I..., ( sizeof...( I ) + J )...> { };
+template <size_t N> struct MakeIndexList 
+    : JoinIndexList<typename MakeIndexList<N / 2>::type, 
+        typename MakeIndexList<N - N / 2>::type> { };
+template <> struct MakeIndexList<0> : IndexList<> { };
+template <> struct MakeIndexList<1> : IndexList<0> { };
+
+// true if the characters of a literal are decimal digits with no leading 0.
+// the digit test is expanded over the whole pack at once: the flags shifted
+// by one place match only if every flag is true
+template <bool... B> struct FlagList { };
+template <char C, char... Cs> struct LiteralCheck
+{
+    static constexpr bool digits = 
+        is_same<FlagList<true, ( C >= '0' && C <= '9' ), 
+            ( Cs >= '0' && Cs <= '9' )...>, 
+        FlagList<( C >= '0' && C <= '9' ), ( Cs >= '0' && Cs <= '9' )..., 
+            true>>::value;
+    static constexpr bool value = digits && 
+        ( C != '0' || sizeof...( Cs ) == 0 );
+};
+
+/*!
+* @brief Static digit list of one LargeInt literal. Node I holds character I
+* of the literal, linked to its neighbours, and is filled in by constant
+* initialization before the program runs. The links are made from the
+* address passed to build, so the initializer names the list only once
+*/
+template <char... Cs> struct LiteralList
+{
+    struct Nodes 
+    { 
+        ListNode node[sizeof...( Cs )]; 
+    };
+    static Nodes nodes;
+
+    template <size_t... I> 
+    static constexpr Nodes build( ListNode* first, IndexList<I...> )
+    {
+        return Nodes { { ListNode( Cs - '0', int( sizeof...( Cs ) - 1 - I ),
+            I + 1 < sizeof...( Cs ) ? first + ( I + 1 ) : nullptr,
+            I > 0 ? first + ( I - 1 ) : nullptr )... } };
+    }
+};
+
+template <char... Cs> 
+typename LiteralList<Cs...>::Nodes LiteralList<Cs...>::nodes = 
+    LiteralList<Cs...>::build( LiteralList<Cs...>::nodes.node, 
+        typename MakeIndexList<sizeof...( Cs )>::type() );
+
+// LargeInt literal: 123456789012345678901234567890_li
+template <char... Cs> constexpr LargeIntConst operator"" _li()
+{
+    static_assert( LiteralCheck<Cs...>::value, 
+        "_li takes decimal digits with no leading zero" );
+    return LargeIntConst( &LiteralList<Cs...>::nodes.node[0], 
+        &LiteralList<Cs...>::nodes.node[sizeof...( Cs ) - 1] );
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* @brief Fixed width sort key of a LargeInt: its length and its first 18
+* digits. Keys order the same way as the numbers they come from, except that
+* equal keys of numbers over 18 digits leave the order to the full compare
+*/
+struct LargeIntKey
+{
+    unsigned length;           /*!< number of digits */
+    uint64_t lead;             /*!< first 18 digits, zero padded */
+
+    LargeIntKey( const LargeInt& value ) : length( value.length() ),
+        lead( value.leading( 18 ) ) { }
+
+    // the key holds every digit, so equal keys mean equal numbers
+    bool exact() const { return length <= 18; }
+};
+
+inline bool operator<( const LargeIntKey& lhs, const LargeIntKey& rhs )
+{
+    return lhs.length != rhs.length ? lhs.length < rhs.length 
+        : lhs.lead < rhs.lead;
+}
+
+inline bool operator==( const LargeIntKey& lhs, const LargeIntKey& rhs )
+{
+    return lhs.length == rhs.length && lhs.lead == rhs.lead;
+}
+
+// sorts values into ascending order by their keys, comparing digits only
+// when keys tie, and sorts then removes duplicate values
+void sort_largeints( vector<LargeInt>& values );
+void unique_largeints( vector<LargeInt>& values );
+
+// hashing for unordered containers, consistent with operator==
+namespace std
+{
+    template <> struct hash<LargeInt>
+    {
+        size_t operator()( const LargeInt& value ) const 
+        {
+            return value.hash(); 
+        }
+    };
+}
+
+//-----------------------------------------------------------------------------
+
+/*!
+* @brief Flag shared between a caller and a running LargeInt operation so the
+* caller can ask the operation to stop early
+*/
+class CancelToken
+{
+    private:
+        atomic<bool> flag { false };    /*!< set once cancel() is called */
+
+    public:
+        void cancel() { flag.store( true, memory_order_relaxed ); }
+        bool cancelled() const { return flag.load( memory_order_relaxed ); }
+};
+
+/*!
+* @brief Error held by the future of an asynchronous operation that was
+* cancelled, so that get() cannot be mistaken for a result
+*/
+class OperationCancelled : public runtime_error
+{
+    public:
+        OperationCancelled() : runtime_error( "LargeInt operation cancelled" )
+        {
+        }
+};
+
+// asynchronous operations, run on an internal pool of worker threads.
+// progress is called from the worker thread. a cancelled operation
+// finishes early, and get() on its future throws OperationCancelled
+future<LargeInt> async_multiply( const LargeInt& a, const LargeInt& b, 
+    shared_ptr<CancelToken> cancel = nullptr, ProgressFn progress = nullptr );
+future<LargeInt> async_add( const LargeInt& a, const LargeInt& b );
+
+//-----------------------------------------------------------------------------
+
+/*!
+* @brief Precomputed reduction for repeated arithmetic modulo one fixed
+* LargeInt modulus. Moduli that fit in a machine word use machine integers;
+* larger ones use division, or from barrett_digits on, Barrett reduction with
+* a reciprocal computed once.
+*/
+class ModContext
+{
+    private:
+        LargeInt mod;          /*!< modulus m */
+        LargeInt mu;           /*!< floor( 10^(2k) / m ), k = digits of m */
+        unsigned k;            /*!< number of digits of m */
+        bool word;             /*!< m fits in a machine word */
+        bool barrett;          /*!< m is long enough to reduce with mu */
+        uint64_t mod64;        /*!< m as a machine integer when word is set */
+
+    public:
+        ModContext( const LargeInt& m );
+
+        const LargeInt& modulus() const { return mod; }
+
+        // results are in [0, m); operands may be any size
+        LargeInt reduce( const LargeInt& x ) const;
+        LargeInt addmod( const LargeInt& a, const LargeInt& b ) const;
+        LargeInt submod( const LargeInt& a, const LargeInt& b ) const;
+        LargeInt mulmod( const LargeInt& a, const LargeInt& b ) const;
+        LargeInt powmod( const LargeInt& base, const LargeInt& exp ) const;
+};
+
+// primality: trial division by small primes, a base 2 Miller-Rabin test and
+// a strong Lucas test (together BPSW), then rounds more Miller-Rabin tests
+bool is_probable_prime( const LargeInt& x, unsigned rounds = 8 );
+
+// smallest probable prime greater than x
+LargeInt next_prime( const LargeInt& x );
+
+//-----------------------------------------------------------------------------
+
+/*!
+* @brief Unsigned integer whose digits live in a file instead of a list, for
+* numbers too large for memory. The file holds one digit per byte, least
+* significant first. Operations stream over the files in fixed size chunks,
+* so their working memory does not grow with the operands.
+*/
+class DiskInt
+{
+    private:
+        string file;           /*!< path of the digit file */
+        uint64_t len;          /*!< number of digits in the file */
+        bool ok;               /*!< set while the file holds the number */
+
+    public:
+        // opens an existing digit file; good() is false if it is missing,
+        // unreadable, empty, or holds a byte that is not a digit 0 to 9 or
+        // a leading zero
+        explicit DiskInt( const string& path );
+        // writes value to a new digit file; good() is false if it could not
+        // be written
+        DiskInt( const string& path, const LargeInt& value );
+
+        // the digit file belongs to one object
+        DiskInt( const DiskInt& ) = delete;
+        DiskInt& operator=( const DiskInt& ) = delete;
+
+        // false if the file could not be opened, was malformed or could not
+        // be written. a DiskInt that is not good reads as 0 with no digits,
+        // and add and multiply refuse it as an operand; as a result it
+        // becomes good once written
+        bool good() const { return ok; }
+
+        const string& path() const { return file; }
+        uint64_t length() const { return len; }
+
+        // reads the whole number into memory
+        LargeInt to_largeint() const;
+
+        // -1, 0 or 1 as lhs is less than, equal to or greater than rhs
+        friend int compare( const DiskInt& lhs, const DiskInt& rhs );
+
+        // result = lhs + rhs and result = lhs * rhs. the result may be one
+        // of the operands; it is written beside its file and renamed over it.
+        // return false, leaving result unchanged, if an operand is not good
+        // or the file could not be written
+        friend bool add( const DiskInt& lhs, const DiskInt& rhs, 
+            DiskInt& result );
+        friend bool multiply( const DiskInt& lhs, const DiskInt& rhs, 
+            DiskInt& result );
+
+        // writes the decimal digits, most significant first
+        friend ostream& operator<<( ostream& out, const DiskInt& value );
+};
+
+int compare( const DiskInt& lhs, const DiskInt& rhs );
+bool add( const DiskInt& lhs, const DiskInt& rhs, DiskInt& result );
+bool multiply( const DiskInt& lhs, const DiskInt& rhs, DiskInt& result );
+
+//-----------------------------------------------------------------------------
+
+/*!
+* @brief Unsigned integer that keeps only its nonzero digits in the list, for
+* numbers that are mostly zeros such as 10^5000000 + 3. The power of each
+* node places it, so addition, multiplication and comparison take time in
+* the number of nonzero digits rather than the length. Zero is a single 0
+* node, as in LargeInt.
+*/
+class SparseInt : public Polynomial
+{
+    private:
+        int compare( const SparseInt& ) const;
+
+    public:
+        SparseInt( unsigned value = 0 ) : SparseInt( LargeInt( value ) ) { }
+        SparseInt( string value ) : SparseInt( LargeInt( value ) ) { }
+        SparseInt( const SparseInt& Q ) : Polynomial( Q ) { }
+        // digit * 10^power, digit from 0 to 9
+        SparseInt( int digit, unsigned power );
+
+        // conversions from and to the dense form
+        SparseInt( const LargeInt& value );
+        LargeInt to_largeint() const;
+
+        const SparseInt& operator=( const SparseInt& );
+
+        friend SparseInt operator+( const SparseInt&, const SparseInt& );
+        friend SparseInt operator*( const SparseInt&, const SparseInt& );
+
+        friend bool operator==( const SparseInt&, const SparseInt& );
+        friend bool operator!=( const SparseInt&, const SparseInt& );
+        friend bool operator<=( const SparseInt&, const SparseInt& );
+        friend bool operator>=( const SparseInt&, const SparseInt& );
+        friend bool operator<( const SparseInt&, const SparseInt& );
+        friend bool operator>( const SparseInt&, const SparseInt& );
+
+        // number of decimal digits, and number of nonzero digits
+        unsigned length() const { return head->power + 1; }
+        unsigned terms() const;
+        bool is_zero() const { return head == tail && head->coeff == 0; }
+
+        friend ostream & operator<<( ostream &, const SparseInt& );
+};
+
 
 
 // end of the multiple includes preprocessor directive
@@ -0,0 +1,218 @@
+/* @file
+ * @brief This file contains the ModContext class, which does repeated
+ * arithmetic modulo one fixed LargeInt: reduce, addmod, submod, mulmod and
+ * powmod.
+ * */
+#include "largeint.h"
+#include "tuning.h"
+
+/*!
+* @brief moduli of at least this many digits use Barrett reduction
+*/
+unsigned barrett_digits = BARRETT_DIGITS;
+
+/*******************************************************
+ *      Function Prototypes for helpers in numtheory.cpp
+ *******************************************************/
+LargeInt fromWord( uint64_t value );
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Precomputes everything needed to reduce modulo m. For
+ * a modulus of barrett_digits or more (and over 19 digits) this is the
+ * Barrett reciprocal mu = floor( 10^(2k) / m ), found with one division.
+ *
+ * @params[in]  m - modulus, must not be 0
+ *
+ * @returns none
+ *
+ * *****************************************************/
+ModContext::ModContext( const LargeInt& m ) : mod( m )
+{
+    k = m.length();
+    word = ( k <= 19 );
+    mod64 = word ? m.to_uint64() : 0;
+    barrett = !word && k >= barrett_digits;
+
+    if ( barrett )
+    {
+        LargeInt b2k = 1;
+
+        b2k.shift_left10( 2 * k );
+        mu = b2k / m;
+    }
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Reduces x modulo m. A machine word modulus uses one
+ * pass of divmod_small. With a Barrett modulus, values of up to 2k digits
+ * use Barrett reduction: q = ( ( x / 10^(k-1) ) * mu ) / 10^(k+1) is at
+ * most 2 below the true quotient, so x - q * m needs at most two
+ * corrections. The divisions by powers of 10 are just decimal shifts.
+ * Shorter moduli and longer values use divmod.
+ *
+ * @params[in]  x - LargeInt to reduce
+ *
+ * @returns x mod m
+ *
+ * *****************************************************/
+LargeInt ModContext::reduce( const LargeInt& x ) const
+{
+    //x % 0 leaves x, as with operator%
+    if ( mod.is_zero() )
+        return x;
+
+    if ( word )
+    {
+        LargeInt q( x );
+        return fromWord( q.divmod_small( mod64 ) );
+    }
+
+    if ( x < mod )
+        return x;
+    if ( !barrett || x.length() > 2 * k )
+        return x % mod;
+
+    //estimate the quotient from the reciprocal
+    LargeInt q( x );
+    q.shift_right10( k - 1 );
+    q = q * mu;
+    q.shift_right10( k + 1 );
+
+    //correct the estimate
+    LargeInt r = x - q * mod;
+    while ( r >= mod )
+        r -= mod;
+    return r;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Adds a and b modulo m with one conditional
+ * subtraction.
+ *
+ * @params[in]  a - first LargeInt to be added
+ * @params[in]  b - second LargeInt to be added
+ *
+ * @returns ( a + b ) mod m
+ *
+ * *****************************************************/
+LargeInt ModContext::addmod( const LargeInt& a, const LargeInt& b ) const
+{
+    if ( word && !mod.is_zero() )
+    {
+        uint64_t x = reduce( a ).to_uint64(), y = reduce( b ).to_uint64();
+        uint64_t sum = x + y;
+
+        //wraps past 2^64 or reaches m, either way subtracting m is exact
+        if ( sum < x || sum >= mod64 )
+            sum -= mod64;
+        return fromWord( sum );
+    }
+
+    LargeInt sum = reduce( a ) + reduce( b );
+    if ( !mod.is_zero() && sum >= mod )
+        sum -= mod;
+    return sum;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Subtracts b from a modulo m, adding m back when b is
+ * the larger residue. LargeInt is unsigned, so the larger residue is
+ * always subtracted from the smaller one plus m.
+ *
+ * @params[in]  a - LargeInt to subtract from
+ * @params[in]  b - LargeInt to be subtracted
+ *
+ * @returns ( a - b ) mod m
+ *
+ * *****************************************************/
+LargeInt ModContext::submod( const LargeInt& a, const LargeInt& b ) const
+{
+    if ( word && !mod.is_zero() )
+    {
+        uint64_t x = reduce( a ).to_uint64(), y = reduce( b ).to_uint64();
+
+        return fromWord( x >= y ? x - y : mod64 - ( y - x ) );
+    }
+
+    LargeInt x = reduce( a ), y = reduce( b );
+    if ( x >= y )
+        return x - y;
+    return x + mod - y;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplies a and b modulo m. A machine word modulus
+ * multiplies the residues in 128 bits; otherwise the full product of the
+ * residues is under 10^(2k) and takes one reduction.
+ *
+ * @params[in]  a - LargeInt multiplicand
+ * @params[in]  b - LargeInt multiplier
+ *
+ * @returns ( a * b ) mod m
+ *
+ * *****************************************************/
+LargeInt ModContext::mulmod( const LargeInt& a, const LargeInt& b ) const
+{
+    if ( word && !mod.is_zero() )
+    {
+        unsigned __int128 prod = reduce( a ).to_uint64();
+
+        prod *= reduce( b ).to_uint64();
+        return fromWord( uint64_t( prod % mod64 ) );
+    }
+
+    return reduce( reduce( a ) * reduce( b ) );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Raises base to exp modulo m, reading exp one decimal
+ * digit at a time from the most significant. Each digit raises the running
+ * result to the 10th power (x^10 = x^8 * x^2, three squarings and one
+ * multiply) and multiplies in base^digit from a table of base^0..base^9.
+ *
+ * @params[in]  base - LargeInt to raise
+ * @params[in]  exp  - exponent
+ *
+ * @returns base^exp mod m
+ *
+ * *****************************************************/
+LargeInt ModContext::powmod( const LargeInt& base, const LargeInt& exp ) const
+{
+    LargeInt table[10];
+    LargeInt result = reduce( LargeInt( 1 ) );
+
+    table[0] = result;
+    table[1] = reduce( base );
+    for ( int i = 2; i < 10; i++ )
+        table[i] = mulmod( table[i - 1], table[1] );
+
+    for ( int i = exp.length() - 1; i >= 0; i-- )
+    {
+        //result^10
+        if ( i != int( exp.length() ) - 1 )
+        {
+            LargeInt sq = mulmod( result, result );
+            result = mulmod( sq, sq );
+            result = mulmod( result, result );
+            result = mulmod( result, sq );
+        }
+
+        int d = exp.digit( i );
+        if ( d != 0 )
+            result = mulmod( result, table[d] );
+    }
+    return result;
+}
@@ -0,0 +1,1030 @@
+/* @file
+ * @brief This file contains LargeInt division and the number theoretic
+ * functions built on it: divmod, operator/, operator%, operator/=,
+ * operator%=, gcd, lcm, extended_gcd, modinv, isqrt, iroot and
+ * is_perfect_power.
+ * */
+#include "largeint.h"
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+/*!
+* @brief number of leading digits used for each Lehmer gcd step
+*/
+static const unsigned LEHMER_DIGITS = 9;
+
+/*!
+* @brief fractional digits kept in the root estimates of iroot and
+* is_perfect_power
+*/
+static const unsigned ROOT_FRACTION = 3;
+
+/*!
+* @brief root estimates with at most this many digits, fraction included,
+* are taken straight from floating point
+*/
+static const unsigned FLOAT_DIGITS = 12;
+
+/*!
+* @brief is_perfect_power tests the exponents below this against power
+* residues modulo small primes before estimating a root
+*/
+static const unsigned SIEVE_EXPONENTS = 64;
+
+/*!
+* @brief a number that is not an n-th power passes the residue tests for n
+* with probability below 2^-SIEVE_BITS
+*/
+static const unsigned SIEVE_BITS = 16;
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Divides num by den using schoolbook long division on
+ * digit arrays (Knuth's algorithm D in base 10). The divisor is first
+ * scaled so its leading digit is at least 5, which lets each quotient digit
+ * be estimated from the top two digits of the running remainder and be off
+ * by at most one. Divisors that fit in a machine word use divmod_small.
+ *
+ * @params[in]  num  - LargeInt dividend
+ * @params[in]  den  - LargeInt divisor
+ * @params[out] quot - num / den (0 if den is 0)
+ * @params[out] rem  - num % den (num if den is 0)
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void divmod( const LargeInt& num, const LargeInt& den, LargeInt& quot, 
+    LargeInt& rem )
+{
+    vector<int> u, v, q;
+    int n, m, d, carry, borrow, t;
+
+    //division by zero or a smaller numerator leaves everything in rem
+    if ( den.is_zero() || num < den )
+    {
+        rem = num;
+        quot = LargeInt();
+        return;
+    }
+
+    //divisor fits in a machine word, so short division is enough
+    if ( den.length() <= 19 )
+    {
+        uint64_t divisor = den.to_uint64();
+        LargeInt q( num );
+        uint64_t r = q.divmod_small( divisor );
+
+        quot = q;
+        rem = LargeInt();
+        rem += r;
+        return;
+    }
+
+    num.toDigits( u );
+    den.toDigits( v );
+    n = v.size();
+    m = u.size() - n;
+    q.assign( m + 1, 0 );
+
+    //normalize so the leading divisor digit is at least 5
+    d = 10 / ( v[n - 1] + 1 );
+    u.push_back( 0 );
+    if ( d > 1 )
+    {
+        carry = 0;
+        for ( int i = 0; i < m + n; i++ )
+        {
+            t = u[i] * d + carry;
+            carry = t / 10;
+            u[i] = t - carry * 10;
+        }
+        u[m + n] = carry;
+
+        carry = 0;
+        for ( int i = 0; i < n; i++ )
+        {
+            t = v[i] * d + carry;
+            carry = t / 10;
+            v[i] = t - carry * 10;
+        }
+    }
+
+    //find each quotient digit from the most significant down
+    for ( int j = m; j >= 0; j-- )
+    {
+        int top = u[j + n] * 10 + u[j + n - 1];
+        int qhat = top / v[n - 1];
+        int rhat = top - qhat * v[n - 1];
+
+        while ( qhat >= 10 || qhat * v[n - 2] > rhat * 10 + u[j + n - 2] )
+        {
+            qhat--;
+            rhat += v[n - 1];
+            if ( rhat >= 10 )
+                break;
+        }
+
+        //subtract qhat times the divisor from the running remainder
+        carry = borrow = 0;
+        for ( int i = 0; i < n; i++ )
+        {
+            int p = qhat * v[i] + carry;
+            carry = p / 10;
+            t = u[i + j] - ( p - carry * 10 ) - borrow;
+            borrow = ( t < 0 );
+            u[i + j] = t + borrow * 10;
+        }
+        t = u[j + n] - carry - borrow;
+        borrow = ( t < 0 );
+        u[j + n] = t + borrow * 10;
+
+        //estimate was one too large, add the divisor back
+        if ( borrow != 0 )
+        {
+            qhat--;
+            carry = 0;
+            for ( int i = 0; i < n; i++ )
+            {
+                t = u[i + j] + v[i] + carry;
+                carry = ( t > 9 );
+                u[i + j] = t - carry * 10;
+            }
+            u[j + n] = ( u[j + n] + carry ) % 10;
+        }
+
+        q[j] = qhat;
+    }
+
+    //undo the normalization on the remainder
+    u.resize( n );
+    t = 0;
+    for ( int i = n - 1; i >= 0; i-- )
+    {
+        t = t * 10 + u[i];
+        u[i] = t / d;
+        t -= u[i] * d;
+    }
+
+    quot.fromDigits( q );
+    rem.fromDigits( u );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Overloads / operator. Calls divmod and keeps only the
+ * quotient.
+ *
+ * @params[in]  lhs - LargeInt dividend
+ * @params[in]  rhs - LargeInt divisor
+ *
+ * @returns quot - LargeInt holding lhs / rhs
+ *
+ * *****************************************************/
+LargeInt operator/( const LargeInt& lhs, const LargeInt& rhs )
+{
+    LargeInt quot, rem;
+
+    divmod( lhs, rhs, quot, rem );
+    return quot;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Overloads % operator. Calls divmod and keeps only the
+ * remainder.
+ *
+ * @params[in]  lhs - LargeInt dividend
+ * @params[in]  rhs - LargeInt divisor
+ *
+ * @returns rem - LargeInt holding lhs % rhs
+ *
+ * *****************************************************/
+LargeInt operator%( const LargeInt& lhs, const LargeInt& rhs )
+{
+    LargeInt quot, rem;
+
+    divmod( lhs, rhs, quot, rem );
+    return rem;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Overloads /= operator. Divides 'this' by a LargeInt
+ * and stores the quotient back into 'this'
+ *
+ * @params[in]  rhs - LargeInt divisor
+ *
+ * @returns reference to new quotient(for chaining purposes)
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::operator/=( const LargeInt& rhs )
+{
+    return *this = *this / rhs;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Overloads %= operator. Reduces 'this' modulo a
+ * LargeInt and stores the remainder back into 'this'
+ *
+ * @params[in]  rhs - LargeInt modulus
+ *
+ * @returns reference to new remainder(for chaining purposes)
+ *
+ * *****************************************************/
+const LargeInt& LargeInt::operator%=( const LargeInt& rhs )
+{
+    return *this = *this % rhs;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Computes A * a + B * b for a pair of Lehmer cofactors.
+ * The cofactors never share a strict sign and the result is known to be
+ * non-negative, so it is found as one product minus the other.
+ *
+ * @params[in]  a - first LargeInt
+ * @params[in]  b - second LargeInt
+ * @params[in]  A - cofactor of a
+ * @params[in]  B - cofactor of b
+ *
+ * @returns LargeInt holding A * a + B * b
+ *
+ * *****************************************************/
+static LargeInt combine( const LargeInt& a, const LargeInt& b, int64_t A, 
+    int64_t B )
+{
+    if ( B <= 0 )
+        return a * uint64_t( A ) - b * uint64_t( -B );
+
+    return b * uint64_t( B ) - a * uint64_t( -A );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Simulates Euclid on the leading LEHMER_DIGITS digits
+ * of a and the digits of b at the same powers, with machine integers, for
+ * as long as the quotients are certain to match those of the full values.
+ * The steps taken are collected in the cofactors, so that A * a + B * b
+ * and C * a + D * b are the two values after them. B is 0 when no step
+ * could be taken.
+ *
+ * @params[in]  a - larger LargeInt
+ * @params[in]  b - smaller LargeInt, longer than LEHMER_DIGITS digits
+ * @params[out] A - cofactor of a in the first value
+ * @params[out] B - cofactor of b in the first value
+ * @params[out] C - cofactor of a in the second value
+ * @params[out] D - cofactor of b in the second value
+ *
+ * @returns number of Euclid steps taken
+ *
+ * *****************************************************/
+static unsigned lehmerSteps( const LargeInt& a, const LargeInt& b, 
+    int64_t& A, int64_t& B, int64_t& C, int64_t& D )
+{
+    //leading digits of a, and the digits of b at the same powers
+    unsigned k = a.length() - LEHMER_DIGITS;
+    int64_t ah = a.digits( k, k + LEHMER_DIGITS ).to_uint64();
+    int64_t bh = b.digits( k, k + LEHMER_DIGITS ).to_uint64();
+    int64_t q, T;
+    unsigned steps = 0;
+
+    A = 1;  B = 0;  C = 0;  D = 1;
+
+    //simulate Euclid while the quotient is certain
+    while ( bh + C != 0 && bh + D != 0 )
+    {
+        q = ( ah + A ) / ( bh + C );
+        if ( q != ( ah + B ) / ( bh + D ) )
+            break;
+
+        T = A - q * C;  A = C;  C = T;
+        T = B - q * D;  B = D;  D = T;
+        T = ah - q * bh;  ah = bh;  bh = T;
+        steps++;
+    }
+    return steps;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds the greatest common divisor with Lehmer's
+ * algorithm. The Euclidean quotients are simulated on the leading
+ * LEHMER_DIGITS digits of both numbers with machine integers, and the
+ * accumulated cofactors are applied to the full LargeInts in one step.
+ * When the simulation cannot make progress a full division step is taken
+ * instead. Once both values fit in a machine word the rest is plain
+ * Euclid.
+ *
+ * @params[in]  x - first LargeInt
+ * @params[in]  y - second LargeInt
+ *
+ * @returns LargeInt holding gcd( x, y )
+ *
+ * *****************************************************/
+LargeInt gcd( const LargeInt& x, const LargeInt& y )
+{
+    LargeInt a = ( x < y ) ? y : x;
+    LargeInt b = ( x < y ) ? x : y;
+    LargeInt t;
+
+    while ( b.length() > LEHMER_DIGITS )
+    {
+        int64_t A, B, C, D;
+
+        lehmerSteps( a, b, A, B, C, D );
+        if ( B == 0 )
+        {
+            //no progress on the leading digits, take a full step
+            t = a % b;
+            a = b;
+            b = t;
+        }
+        else
+        {
+            t = combine( a, b, A, B );
+            b = combine( a, b, C, D );
+            a = t;
+        }
+    }
+
+    //finish with machine integers
+    if ( b.is_zero() )
+        return a;
+
+    uint64_t u = ( a % b ).to_uint64();
+    uint64_t v = b.to_uint64();
+    while ( u != 0 )
+    {
+        uint64_t r = v % u;
+        v = u;
+        u = r;
+    }
+
+    return LargeInt( unsigned( v ) );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds the least common multiple as x / gcd( x, y ) * y,
+ * dividing first to keep the intermediate small.
+ *
+ * @params[in]  x - first LargeInt
+ * @params[in]  y - second LargeInt
+ *
+ * @returns LargeInt holding lcm( x, y ), 0 if either is 0
+ *
+ * *****************************************************/
+LargeInt lcm( const LargeInt& x, const LargeInt& y )
+{
+    if ( x.is_zero() || y.is_zero() )
+        return LargeInt();
+
+    return x / gcd( x, y ) * y;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Applies the cofactors of a Lehmer step to a pair of
+ * Bezout cofactors. Along the Euclidean sequence the signs of the Bezout
+ * cofactors alternate, and so do the signs in each row of a Lehmer step,
+ * so the two products in each row always agree in sign and only their
+ * magnitudes are added.
+ *
+ * @params[in,out] s0 - magnitude of the cofactor of the first value
+ * @params[in,out] s1 - magnitude of the cofactor of the second value
+ * @params[in]     A  - cofactor of the first value in the first row
+ * @params[in]     B  - cofactor of the second value in the first row
+ * @params[in]     C  - cofactor of the first value in the second row
+ * @params[in]     D  - cofactor of the second value in the second row
+ *
+ * @returns none
+ *
+ * *****************************************************/
+static void advance( LargeInt& s0, LargeInt& s1, int64_t A, int64_t B, 
+    int64_t C, int64_t D )
+{
+    LargeInt next = s0 * uint64_t( llabs( A ) ) + s1 * uint64_t( llabs( B ) );
+
+    s1 = s0 * uint64_t( llabs( C ) ) + s1 * uint64_t( llabs( D ) );
+    s0 = next;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Extended Euclidean algorithm for the cofactor of a
+ * alone, with the Lehmer steps of gcd. Each step found on the leading
+ * digits is applied to the remainders and to the pair of Bezout cofactors
+ * at once; when none can be found, and once the remainders fit in
+ * LEHMER_DIGITS digits, a full division step is taken. LargeInt is
+ * unsigned, so only the magnitudes of the cofactors are tracked, and their
+ * signs follow from the parity of the number of Euclid steps. If that
+ * count is odd the cofactor is reflected by b / g, so that a * x == g
+ * (mod b) holds with x non-negative.
+ *
+ * @params[in]  a - first LargeInt
+ * @params[in]  b - second LargeInt
+ * @params[out] x - cofactor of a, at most b / g
+ *
+ * @returns g - LargeInt holding gcd( a, b )
+ *
+ * *****************************************************/
+static LargeInt cofactor( const LargeInt& a, const LargeInt& b, LargeInt& x )
+{
+    LargeInt r0 = a, r1 = b, s0 = 1, s1 = 0, q, r;
+    bool odd = false;
+
+    //a first step with quotient 0 puts the larger value first
+    if ( a < b )
+    {
+        r0.swap( r1 );
+        s0.swap( s1 );
+        odd = true;
+    }
+
+    while ( !r1.is_zero() )
+    {
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        unsigned steps = 0;
+
+        if ( r1.length() > LEHMER_DIGITS )
+            steps = lehmerSteps( r0, r1, A, B, C, D );
+
+        if ( B == 0 )
+        {
+            //no progress on the leading digits, take a full step
+            divmod( r0, r1, q, r );
+            r0 = r1;
+            r1 = r;
+
+            r = s0 + q * s1;
+            s0 = s1;
+            s1 = r;
+
+            odd = !odd;
+        }
+        else
+        {
+            r = combine( r0, r1, A, B );
+            r1 = combine( r0, r1, C, D );
+            r0 = r;
+
+            advance( s0, s1, A, B, C, D );
+            odd = ( odd != ( steps % 2 == 1 ) );
+        }
+    }
+
+    //r0 is the gcd, with r0 == +-( s0 * a - t * b ) for some t
+    x = odd ? b / r0 - s0 : s0;
+    return r0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Extended Euclidean algorithm. The cofactor of a is
+ * found with the Lehmer steps of cofactor(), and the cofactor of b follows
+ * from it with one exact division, so that a * x - b * y == g holds with x
+ * and y both non-negative.
+ *
+ * @params[in]  a - first LargeInt (must not be 0 for the identity to hold)
+ * @params[in]  b - second LargeInt
+ * @params[out] x - cofactor of a
+ * @params[out] y - cofactor of b
+ *
+ * @returns g - LargeInt holding gcd( a, b )
+ *
+ * *****************************************************/
+LargeInt extended_gcd( const LargeInt& a, const LargeInt& b, LargeInt& x, 
+    LargeInt& y )
+{
+    LargeInt g = cofactor( a, b, x );
+
+    y = ( a * x - g ) / b;
+    return g;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds the inverse of a modulo m as the cofactor of
+ * a mod m in its extended gcd with m; the cofactor of m is not needed. An
+ * inverse exists only when that gcd is 1.
+ *
+ * @params[in]  a   - LargeInt to invert
+ * @params[in]  m   - LargeInt modulus
+ * @params[out] inv - inverse of a in [0, m), unchanged if none exists
+ *
+ * @returns true if the inverse exists, false otherwise
+ *
+ * *****************************************************/
+bool modinv( const LargeInt& a, const LargeInt& m, LargeInt& inv )
+{
+    LargeInt x;
+
+    if ( m.is_zero() )
+        return false;
+
+    if ( cofactor( a % m, m, x ) != LargeInt( 1 ) )
+        return false;
+
+    inv = x % m;
+    return true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Builds a LargeInt from a machine integer without going
+ * through the 32 bit Polynomial constructor. Shared with modctx.cpp.
+ *
+ * @params[in]  value - integer to convert
+ *
+ * @returns LargeInt holding value
+ *
+ * *****************************************************/
+LargeInt fromWord( uint64_t value )
+{
+    LargeInt result;
+
+    result += value;
+    return result;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds x mod p for every prime p in a table. The primes
+ * are grouped into products that fit a machine word, so each group costs
+ * one divmod_small pass over x instead of one pass per prime. Shared with
+ * prime.cpp.
+ *
+ * @params[in]  x      - LargeInt to reduce
+ * @params[in]  primes - primes to reduce by, each below 2^32
+ * @params[out] res    - x mod p for each prime in primes
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void residues( const LargeInt& x, const vector<unsigned>& primes, 
+    vector<unsigned>& res )
+{
+    size_t i = 0;
+
+    res.resize( primes.size() );
+    while ( i < primes.size() )
+    {
+        //gather primes while the product stays below UINT64_MAX / 10
+        uint64_t group = 1;
+        size_t j = i;
+        while ( j < primes.size() && group <= UINT64_MAX / 10 / primes[j] )
+            group *= primes[j++];
+
+        LargeInt q( x );
+        uint64_t r = q.divmod_small( group );
+        for ( ; i < j; i++ )
+            res[i] = r % primes[i];
+    }
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Raises a LargeInt to a machine integer power by
+ * repeated squaring.
+ *
+ * @params[in]  base - LargeInt to raise
+ * @params[in]  n    - exponent
+ *
+ * @returns LargeInt holding base^n
+ *
+ * *****************************************************/
+static LargeInt ipow( LargeInt base, unsigned n )
+{
+    LargeInt result = 1;
+
+    while ( n != 0 )
+    {
+        if ( n & 1 )
+            result *= base;
+        n >>= 1;
+        if ( n != 0 )
+            base *= base;
+    }
+    return result;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Drops the low digits of v past its first keep digits,
+ * counting them in the decimal exponent e, so that v * 10^e keeps its
+ * value to keep significant digits.
+ *
+ * @params[in,out] v    - LargeInt to truncate
+ * @params[in]     keep - number of digits to keep
+ * @params[in,out] e    - decimal exponent of v
+ *
+ * @returns none
+ *
+ * *****************************************************/
+static void truncate( LargeInt& v, unsigned keep, int64_t& e )
+{
+    if ( v.length() <= keep )
+        return;
+
+    e += v.length() - keep;
+    v.shift_right10( v.length() - keep );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplies v by 10^e in place, dropping the fraction
+ * when e is negative.
+ *
+ * @params[in,out] v - LargeInt to scale
+ * @params[in]     e - power of 10 to scale by
+ *
+ * @returns none
+ *
+ * *****************************************************/
+static void scale10( LargeInt& v, int64_t e )
+{
+    if ( e > 0 )
+        v.shift_left10( unsigned( e ) );
+    else if ( e < 0 && -e > int64_t( v.length() ) )
+        v = LargeInt();
+    else if ( e < 0 )
+        v.shift_right10( unsigned( -e ) );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Raises base to a machine integer power by repeated
+ * squaring, truncating every product to keep digits, so that the result
+ * times 10^e is base^n to about keep significant digits.
+ *
+ * @params[in]  base - LargeInt to raise
+ * @params[in]  n    - exponent
+ * @params[in]  keep - significant digits kept
+ * @params[out] e    - decimal exponent of the result
+ *
+ * @returns LargeInt holding the leading digits of base^n
+ *
+ * *****************************************************/
+static LargeInt powTruncated( LargeInt base, unsigned n, unsigned keep, 
+    int64_t& e )
+{
+    LargeInt result = 1;
+    int64_t eb = 0;
+
+    e = 0;
+    while ( n != 0 )
+    {
+        if ( n & 1 )
+        {
+            result *= base;
+            e += eb;
+            truncate( result, keep, e );
+        }
+        n >>= 1;
+        if ( n != 0 )
+        {
+            base *= base;
+            eb *= 2;
+            truncate( base, keep, eb );
+        }
+    }
+    return result;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Estimates x^(1/n) * 10^f to within a unit, from no
+ * more of x than the root needs. Short roots come from the logarithm of
+ * the leading digits. Longer roots use Newton's method for the reciprocal
+ * root z = 10^q / x^(1/n), which needs only multiplications:
+ * z += z ( 1 - x z^n 10^(-nq) ) / n. The steps run in fixed point at
+ * increasing precision, each one doubling the correct digits of z, so
+ * only the last runs at the full q + f digits of the root and more. The
+ * root is then x z^(n-1) 10^(-q(n-1)).
+ *
+ * @params[in]  x - LargeInt to take the root of, not 0
+ * @params[in]  n - degree of the root, at least 2
+ * @params[in]  f - number of fractional digits
+ *
+ * @returns LargeInt within 1 of x^(1/n) * 10^f
+ *
+ * *****************************************************/
+static LargeInt rootEstimate( const LargeInt& x, unsigned n, unsigned f )
+{
+    unsigned len = x.length(), lead = min( len, 17u );
+    unsigned q = ( len + n - 1 ) / n, nd = 0;
+    int64_t ex, ez;
+
+    //log10 of the root; the whole part of ( len - lead ) / n is kept apart
+    //so the fraction keeps its precision on long numbers
+    double top = log10( double( x.digits( len - lead, len ).to_uint64() ) );
+    unsigned whole = ( len - lead ) / n;
+    double frac = ( top + ( len - lead ) % n ) / n;
+
+    if ( q + f <= FLOAT_DIGITS )
+        return fromWord( uint64_t( pow( 10.0, whole + frac + f ) ) );
+
+    for ( unsigned m = n; m != 0; m /= 10 )
+        nd++;
+
+    //z is between 1 and 10^(1 + 1/n), held as Z = z * 10^w; the floating
+    //point start has 12 correct digits
+    unsigned good = 12, w = good + 2;
+    unsigned need = q + f + nd + 2;
+    LargeInt Z = fromWord( uint64_t( pow( 10.0, ( q - whole ) - frac + w ) ) );
+    LargeInt one = 1;
+
+    one.shift_left10( w );
+    while ( good < need )
+    {
+        //a step squares the error and multiplies it by about n / 2
+        unsigned next = min( need, 2 * good - nd - 1 );
+        Z.shift_left10( next + 2 - w );
+        one.shift_left10( next + 2 - w );
+        w = next + 2;
+        good = next;
+
+        //W = x z^n 10^(-nq), scaled by 10^w
+        LargeInt W = x.digits( len - min( len, w + 3 ), len );
+        W *= powTruncated( Z, n, w + 3, ez );
+        ex = len - min( len, w + 3 );
+        scale10( W, ex + ez - int64_t( n ) * ( q + w ) + w );
+
+        //the sign of 1 - W is kept apart, as LargeInt is unsigned
+        LargeInt step = Z * ( ( W < one ) ? one - W : W - one );
+        step.shift_right10( w );
+        step.divmod_small( n );
+        if ( W < one )
+            Z += step;
+        else
+            Z -= step;
+    }
+
+    LargeInt root = x.digits( len - min( len, w + 3 ), len );
+    root *= powTruncated( Z, n - 1, w + 3, ez );
+    ex = len - min( len, w + 3 );
+    scale10( root, ex + ez - int64_t( n - 1 ) * ( q + w ) + f );
+    return root;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds floor( x^(1/n) ) from a root estimate with
+ * ROOT_FRACTION fractional digits. The estimate is within a unit of its
+ * last digit, so its whole part is the floor unless the fraction is next
+ * to 0 or 1; only then is the candidate raised to the n-th power and
+ * corrected against x. A degree past the bit length of x gives 1 without
+ * any powers.
+ *
+ * @params[in]  x - LargeInt to take the root of
+ * @params[in]  n - degree of the root, at least 1
+ *
+ * @returns LargeInt holding floor( x^(1/n) )
+ *
+ * *****************************************************/
+LargeInt iroot( const LargeInt& x, unsigned n )
+{
+    if ( n <= 1 || x.is_zero() )
+        return x;
+
+    //2^n > x once n reaches this bound, as a digit is under 3.33 bits
+    if ( n > x.length() * 10 / 3 )
+        return LargeInt( 1 );
+
+    LargeInt r = rootEstimate( x, n, ROOT_FRACTION );
+    uint64_t frac = r.digits( 0, ROOT_FRACTION ).to_uint64();
+    uint64_t last = 1;
+
+    for ( unsigned i = 0; i < ROOT_FRACTION; i++ )
+        last *= 10;
+    r.shift_right10( ROOT_FRACTION );
+
+    if ( frac != 0 && frac != last - 1 )
+        return r;
+
+    //the root may be on either side of an integer
+    if ( frac != 0 )
+        ++r;
+    while ( ipow( r, n ) > x )
+        --r;
+    while ( ipow( r + 1, n ) <= x )
+        ++r;
+    return r;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds floor( sqrt( x ) ). Values that fit in a
+ * machine word use the floating point square root, corrected to the exact
+ * floor; larger values use iroot.
+ *
+ * @params[in]  x - LargeInt to take the square root of
+ *
+ * @returns LargeInt holding floor( sqrt( x ) )
+ *
+ * *****************************************************/
+LargeInt isqrt( const LargeInt& x )
+{
+    if ( x.length() > 18 )
+        return iroot( x, 2 );
+
+    uint64_t v = x.to_uint64();
+    uint64_t r = uint64_t( sqrt( double( v ) ) );
+
+    //correct the floating point estimate
+    while ( r * r > v )
+        r--;
+    while ( ( r + 1 ) * ( r + 1 ) <= v )
+        r++;
+
+    return LargeInt( unsigned( r ) );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Returns the primes used to test power residues. For
+ * each prime n below SIEVE_EXPONENTS it takes primes p = 1 (mod n), where
+ * only one residue in n is an n-th power, until a number that is not an
+ * n-th power passes them all with probability below 2^-SIEVE_BITS. They
+ * are found once on first use.
+ *
+ * @params  none
+ *
+ * @returns reference to the sorted table of residue primes
+ *
+ * *****************************************************/
+static const vector<unsigned>& residuePrimes()
+{
+    static const vector<unsigned> table = []
+    {
+        vector<unsigned> primes;
+
+        for ( unsigned n = 2; n < SIEVE_EXPONENTS; n++ )
+        {
+            bool prime = true;
+            for ( unsigned d = 2; d * d <= n && prime; d++ )
+                prime = ( n % d != 0 );
+            if ( !prime )
+                continue;
+
+            double pass = 1;
+            for ( unsigned p = n + 1; pass * ( 1 << SIEVE_BITS ) > 1; p += n )
+            {
+                prime = ( p % 2 != 0 );
+                for ( unsigned d = 3; d * d <= p && prime; d += 2 )
+                    prime = ( p % d != 0 );
+                if ( !prime )
+                    continue;
+
+                primes.push_back( p );
+                pass /= n;
+            }
+        }
+
+        sort( primes.begin(), primes.end() );
+        primes.erase( unique( primes.begin(), primes.end() ), primes.end() );
+        return primes;
+    }();
+
+    return table;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Checks the residues of x against n: for each residue
+ * prime p = 1 (mod n) that does not divide x, x mod p must be an n-th
+ * power modulo p, which is when x^((p - 1) / n) = 1 (mod p).
+ *
+ * @params[in]  res - x mod p for each prime in residuePrimes()
+ * @params[in]  n   - prime exponent
+ *
+ * @returns false if x cannot be an n-th power, true otherwise
+ *
+ * *****************************************************/
+static bool powerResidues( const vector<unsigned>& res, unsigned n )
+{
+    const vector<unsigned>& primes = residuePrimes();
+
+    for ( size_t i = 0; i < primes.size(); i++ )
+    {
+        uint64_t p = primes[i], e = ( p - 1 ) / n, b = res[i], r = 1;
+
+        if ( ( p - 1 ) % n != 0 || b == 0 )
+            continue;
+
+        for ( ; e != 0; e >>= 1 )
+        {
+            if ( e & 1 )
+                r = r * b % p;
+            b = b * b % p;
+        }
+        if ( r != 1 )
+            return false;
+    }
+    return true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Checks whether x is a perfect power, trying each prime
+ * exponent n up to log2( x ); composite exponents are covered by their
+ * prime factors. Each n is rejected by the cheapest test that can:
+ *      1. for small n, x must be an n-th power modulo a few small primes
+ *      2. x^(1/n) is estimated to a few fractional digits from the leading
+ *         digits of x, and must be next to an integer r
+ *      3. r^n and x must agree in their last 18 digits
+ *      4. r^n must equal x
+ * so the full power is only formed for a likely root.
+ *
+ * @params[in]  x - LargeInt to check
+ *
+ * @returns true if x == r^n for some r and some n >= 2, false otherwise
+ *
+ * *****************************************************/
+bool is_perfect_power( const LargeInt& x )
+{
+    //0 and 1 are squares
+    if ( x.length() == 1 && x.digit( 0 ) <= 1 )
+        return true;
+
+    //2^maxexp > x, since each decimal digit is under 3.33 bits
+    unsigned maxexp = x.length() * 10 / 3 + 1;
+    unsigned m = min( x.length(), 18u );
+    uint64_t low = x.digits( 0, m ).to_uint64(), mod = 1, last = 1;
+    vector<bool> composite( maxexp + 1, false );
+    vector<unsigned> res;
+
+    for ( unsigned i = 0; i < m; i++ )
+        mod *= 10;
+    for ( unsigned i = 0; i < ROOT_FRACTION; i++ )
+        last *= 10;
+
+    residues( x, residuePrimes(), res );
+
+    for ( unsigned n = 2; n <= maxexp; n++ )
+    {
+        if ( composite[n] )
+            continue;
+        for ( uint64_t j = uint64_t( n ) * n; j <= maxexp; j += n )
+            composite[j] = true;
+
+        if ( n < SIEVE_EXPONENTS && !powerResidues( res, n ) )
+            continue;
+
+        LargeInt r = rootEstimate( x, n, ROOT_FRACTION );
+        uint64_t frac = r.digits( 0, ROOT_FRACTION ).to_uint64();
+        r.shift_right10( ROOT_FRACTION );
+        if ( frac == last - 1 )
+        {
+            ++r;
+            frac = 0;
+        }
+
+        //roots only get smaller with n
+        if ( r < LargeInt( 2 ) )
+            break;
+        if ( frac != 0 )
+            continue;
+
+        //last digits of r^n
+        uint64_t b = r.digits( 0, m ).to_uint64(), p = 1;
+        for ( unsigned e = n; e != 0; e >>= 1 )
+        {
+            if ( e & 1 )
+                p = ( unsigned __int128 ) p * b % mod;
+            b = ( unsigned __int128 ) b * b % mod;
+        }
+
+        if ( p == low && ipow( r, n ) == x )
+            return true;
+    }
+    return false;
+}
@@ -88,6 +88,21 @@ using namespace std;
 
 #include "largeint.h"
 
+//compile check: literals find the LargeInt operators on their own, with
+//another literal or with a machine integer on either side
+static_assert( is_same<decltype( 5_li + 7_li ), LargeInt>::value &&
+    is_same<decltype( 7_li - 5_li ), LargeInt>::value &&
+    is_same<decltype( 5_li * 3 ), LargeInt>::value &&
+    is_same<decltype( 3 * 5_li ), LargeInt>::value &&
+    is_same<decltype( 5_li + 3 ), LargeInt>::value &&
+    is_same<decltype( 7_li - 3 ), LargeInt>::value &&
+    is_same<decltype( 7_li / 5_li ), LargeInt>::value &&
+    is_same<decltype( 7_li % 3 ), LargeInt>::value &&
+    is_same<decltype( 5_li == 7_li ), bool>::value &&
+    is_same<decltype( 5_li < 3 ), bool>::value &&
+    is_same<decltype( 3 >= 5_li ), bool>::value,
+    "LargeInt operators must accept _li literal operands" );
+
 //-----------------------------------------------------------------------------
 //          ***** main program to test LargeInt class *****
 //-----------------------------------------------------------------------------
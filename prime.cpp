@@ -0,0 +1,375 @@
+/* @file
+ * @brief This file contains the primality functions for LargeInt:
+ * is_probable_prime and next_prime.
+ * */
+#include "largeint.h"
+
+/*!
+* @brief small primes below this bound are used for trial division and
+* sieving
+*/
+static const unsigned SMALL_PRIME_BOUND = 2000;
+
+/*!
+* @brief number of odd candidates sieved at once by next_prime
+*/
+static const unsigned SIEVE_WINDOW = 4096;
+
+/*******************************************************
+ *      Function Prototypes for helpers in numtheory.cpp
+ *******************************************************/
+void residues( const LargeInt& x, const vector<unsigned>& primes, 
+    vector<unsigned>& res );
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Returns the odd primes below SMALL_PRIME_BOUND, found
+ * once with a sieve of Eratosthenes on first use.
+ *
+ * @params  none
+ *
+ * @returns reference to the table of odd small primes
+ *
+ * *****************************************************/
+static const vector<unsigned>& smallPrimes()
+{
+    static const vector<unsigned> table = []
+    {
+        vector<bool> composite( SMALL_PRIME_BOUND, false );
+        vector<unsigned> primes;
+
+        for ( unsigned i = 3; i < SMALL_PRIME_BOUND; i += 2 )
+        {
+            if ( composite[i] )
+                continue;
+            primes.push_back( i );
+            for ( unsigned j = i * i; j < SMALL_PRIME_BOUND; j += 2 * i )
+                composite[j] = true;
+        }
+        return primes;
+    }();
+
+    return table;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Jacobi symbol ( a / n ) for machine integers, n odd.
+ *
+ * @params[in]  a - numerator
+ * @params[in]  n - odd denominator
+ *
+ * @returns -1, 0 or 1
+ *
+ * *****************************************************/
+static int jacobi( uint64_t a, uint64_t n )
+{
+    int result = 1;
+
+    a %= n;
+    while ( a != 0 )
+    {
+        while ( a % 2 == 0 )
+        {
+            a /= 2;
+            if ( n % 8 == 3 || n % 8 == 5 )
+                result = -result;
+        }
+        swap( a, n );
+        if ( a % 4 == 3 && n % 4 == 3 )
+            result = -result;
+        a %= n;
+    }
+    return ( n == 1 ) ? result : 0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Splits a LargeInt into bits, least significant first,
+ * 32 bits per divmod_small pass.
+ *
+ * @params[in]  x    - LargeInt to split
+ * @params[out] bits - bits of x
+ *
+ * @returns none
+ *
+ * *****************************************************/
+static void toBits( LargeInt x, vector<bool>& bits )
+{
+    bits.clear();
+    while ( !x.is_zero() )
+    {
+        uint64_t chunk = x.divmod_small( uint64_t( 1 ) << 32 );
+        for ( int i = 0; i < 32; i++ )
+            bits.push_back( ( chunk >> i ) & 1 );
+    }
+
+    //drop the zero bits above the top of the last chunk
+    while ( !bits.empty() && !bits.back() )
+        bits.pop_back();
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Strong probable prime (Miller-Rabin) test of n to a
+ * given base, with n - 1 = d * 2^s already split out.
+ *
+ * @params[in]  ctx   - reduction context for n
+ * @params[in]  base  - base of the test
+ * @params[in]  d     - odd part of n - 1
+ * @params[in]  s     - power of 2 in n - 1
+ * @params[in]  nless - n - 1
+ *
+ * @returns true if n is a strong probable prime to base
+ *
+ * *****************************************************/
+static bool millerRabin( const ModContext& ctx, const LargeInt& base, 
+    const LargeInt& d, unsigned s, const LargeInt& nless )
+{
+    LargeInt x = ctx.powmod( base, d );
+
+    if ( x == LargeInt( 1 ) || x == nless )
+        return true;
+
+    for ( unsigned r = 1; r < s; r++ )
+    {
+        x = ctx.mulmod( x, x );
+        if ( x == nless )
+            return true;
+        if ( x == LargeInt( 1 ) )
+            return false;
+    }
+    return false;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Halves a residue modulo the odd modulus n, adding n
+ * first when the residue is odd.
+ *
+ * @params[in]  x - residue in [0, n)
+ * @params[in]  n - odd modulus
+ *
+ * @returns x / 2 mod n
+ *
+ * *****************************************************/
+static LargeInt half( LargeInt x, const LargeInt& n )
+{
+    if ( x.digit( 0 ) % 2 != 0 )
+        x += n;
+    x.divmod_small( 2 );
+    return x;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Strong Lucas probable prime test with Selfridge's
+ * parameters: D is the first of 5, -7, 9, -11, ... with ( D / n ) = -1,
+ * P = 1 and Q = ( 1 - D ) / 4. With n + 1 = d * 2^s, n passes if
+ * U_d = 0 or V_(d 2^r) = 0 (mod n) for some r < s. U and V are found with
+ * the binary doubling ladder over the bits of d. n must be odd, not a
+ * perfect square, and have no factor below SMALL_PRIME_BOUND.
+ *
+ * @params[in]  ctx - reduction context for n
+ * @params[in]  n   - odd LargeInt to test
+ *
+ * @returns true if n is a strong Lucas probable prime
+ *
+ * *****************************************************/
+static bool strongLucas( const ModContext& ctx, const LargeInt& n )
+{
+    //choose D; ( D / n ) for small odd |D| by quadratic reciprocity
+    int64_t D = 5;
+    bool nmod4is1 = ( n.digits( 0, 2 ).to_uint64() % 4 == 1 );
+    while ( true )
+    {
+        uint64_t a = ( D < 0 ) ? -D : D;
+        LargeInt q( n );
+        int j = jacobi( q.divmod_small( a ), a );
+
+        if ( !nmod4is1 && a % 4 == 3 )
+            j = -j;
+        if ( D < 0 && !nmod4is1 )
+            j = -j;
+        if ( j == -1 )
+            break;
+        D = ( D > 0 ) ? -( D + 2 ) : -D + 2;
+    }
+
+    //residues of D, Q and their negatives mod n
+    uint64_t absD = ( D < 0 ) ? -D : D;
+    int64_t Q = ( 1 - D ) / 4;
+    LargeInt Dmod = ( D < 0 ) ? n - absD : LargeInt() + absD;
+    LargeInt Qmod = ( Q < 0 ) ? n - uint64_t( -Q ) : LargeInt() + uint64_t( Q );
+
+    //n + 1 = d * 2^s
+    vector<bool> bits;
+    toBits( n + 1, bits );
+    unsigned s = 0;
+    while ( !bits[s] )
+        s++;
+
+    //ladder over the bits of d from the top, starting at U_1, V_1
+    LargeInt U = 1, V = 1, Qk = Qmod;
+    for ( int i = int( bits.size() ) - 2; i >= int( s ); i-- )
+    {
+        U = ctx.mulmod( U, V );
+        V = ctx.submod( ctx.mulmod( V, V ), ctx.addmod( Qk, Qk ) );
+        Qk = ctx.mulmod( Qk, Qk );
+
+        if ( bits[i] )
+        {
+            LargeInt nextU = half( ctx.addmod( U, V ), n );
+            V = half( ctx.addmod( ctx.mulmod( Dmod, U ), V ), n );
+            U = nextU;
+            Qk = ctx.mulmod( Qk, Qmod );
+        }
+    }
+
+    if ( U.is_zero() || V.is_zero() )
+        return true;
+
+    //V_(2k) = V_k^2 - 2 Q^k
+    for ( unsigned r = 1; r < s; r++ )
+    {
+        V = ctx.submod( ctx.mulmod( V, V ), ctx.addmod( Qk, Qk ) );
+        if ( V.is_zero() )
+            return true;
+        Qk = ctx.mulmod( Qk, Qk );
+    }
+    return false;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Tests x for primality. Trial division by the small
+ * primes removes most composites with a few passes of divmod_small. The
+ * rest go through the Baillie-PSW test (a base 2 Miller-Rabin test and a
+ * strong Lucas test, with no known counterexample), and then rounds more
+ * Miller-Rabin tests to the bases 3, 5, 7, ...
+ *
+ * @params[in]  x      - LargeInt to test
+ * @params[in]  rounds - extra Miller-Rabin rounds after BPSW
+ *
+ * @returns true if x is a probable prime, false if x is composite
+ *
+ * *****************************************************/
+bool is_probable_prime( const LargeInt& x, unsigned rounds )
+{
+    const vector<unsigned>& primes = smallPrimes();
+    vector<unsigned> res;
+
+    //0, 1 and the even numbers other than 2
+    if ( x.length() == 1 && x.digit( 0 ) < 2 )
+        return false;
+    if ( x.digit( 0 ) % 2 == 0 )
+        return x.length() == 1 && x.digit( 0 ) == 2;
+
+    //trial division; small values are decided here
+    residues( x, smallPrimes(), res );
+    for ( size_t i = 0; i < primes.size(); i++ )
+        if ( res[i] == 0 )
+            return x.length() <= 4 && x.to_uint64() == primes[i];
+    if ( x < LargeInt( SMALL_PRIME_BOUND ) * SMALL_PRIME_BOUND )
+        return true;
+
+    ModContext ctx( x );
+    LargeInt nless = x - 1;
+    LargeInt d = nless;
+    unsigned s = 0;
+    while ( d.digit( 0 ) % 2 == 0 )
+    {
+        d.divmod_small( 2 );
+        s++;
+    }
+
+    if ( !millerRabin( ctx, LargeInt( 2 ), d, s, nless ) )
+        return false;
+
+    //the Lucas test needs a D that only exists for non-squares
+    LargeInt root = isqrt( x );
+    if ( root * root == x || !strongLucas( ctx, x ) )
+        return false;
+
+    for ( unsigned r = 0; r < rounds && r < primes.size(); r++ )
+        if ( !millerRabin( ctx, LargeInt( primes[r] ), d, s, nless ) )
+            return false;
+
+    return true;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds the smallest probable prime greater than x. Odd
+ * candidates are sieved SIEVE_WINDOW at a time: x mod p is found once for
+ * each small prime p, every multiple of p in the window is crossed off,
+ * and the residues are stepped forward for the next window without
+ * touching x again. Only the survivors get the full primality test.
+ *
+ * @params[in]  x - LargeInt to start after
+ *
+ * @returns smallest probable prime greater than x
+ *
+ * *****************************************************/
+LargeInt next_prime( const LargeInt& x )
+{
+    const vector<unsigned>& primes = smallPrimes();
+    vector<unsigned> res;
+    vector<bool> crossed;
+
+    //small values, where the sieve could cross off the primes themselves
+    if ( x < LargeInt( SMALL_PRIME_BOUND ) )
+    {
+        LargeInt cand = x + 1;
+        while ( !is_probable_prime( cand ) )
+            ++cand;
+        return cand;
+    }
+
+    //first odd candidate
+    LargeInt start = x + 1;
+    if ( start.digit( 0 ) % 2 == 0 )
+        ++start;
+    residues( start, smallPrimes(), res );
+
+    while ( true )
+    {
+        //cross off odd multiples of each small prime
+        crossed.assign( SIEVE_WINDOW, false );
+        for ( size_t i = 0; i < primes.size(); i++ )
+        {
+            unsigned p = primes[i];
+            //start + 2 * k == 0 (mod p) at k == ( p - r ) * ( p + 1 ) / 2
+            unsigned k = uint64_t( ( p - res[i] ) % p ) * ( ( p + 1 ) / 2 ) % p;
+            for ( ; k < SIEVE_WINDOW; k += p )
+                crossed[k] = true;
+        }
+
+        //test the survivors in order
+        LargeInt cand = start;
+        unsigned at = 0;
+        for ( unsigned k = 0; k < SIEVE_WINDOW; k++ )
+        {
+            if ( crossed[k] )
+                continue;
+            cand += 2 * ( k - at );
+            at = k;
+            if ( is_probable_prime( cand ) )
+                return cand;
+        }
+
+        //step to the next window
+        start += 2 * SIEVE_WINDOW;
+        for ( size_t i = 0; i < primes.size(); i++ )
+            res[i] = ( res[i] + 2 * SIEVE_WINDOW ) % primes[i];
+    }
+}
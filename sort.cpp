@@ -0,0 +1,113 @@
+/* @file
+ * @brief This file contains the sorting functions for collections of
+ * LargeInts: sort_largeints and unique_largeints.
+ * */
+#include "largeint.h"
+#include <algorithm>
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Sorts values together with their keys. An order of
+ * indices is sorted by key, with the full compare only for tied keys of
+ * numbers over 18 digits. The values and keys are then moved into that
+ * order by following the cycles of the permutation with swaps, so no
+ * LargeInt is copied.
+ *
+ * @params[in,out] values - LargeInts to sort
+ * @params[out]    keys   - keys of the sorted values
+ *
+ * @returns none
+ *
+ * *****************************************************/
+static void sortKeyed( vector<LargeInt>& values, vector<LargeIntKey>& keys )
+{
+    vector<size_t> order( values.size() );
+
+    keys.clear();
+    keys.reserve( values.size() );
+    for ( size_t i = 0; i < values.size(); i++ )
+    {
+        keys.push_back( LargeIntKey( values[i] ) );
+        order[i] = i;
+    }
+
+    sort( order.begin(), order.end(), [&]( size_t a, size_t b )
+    {
+        if ( !( keys[a] == keys[b] ) )
+            return keys[a] < keys[b];
+        return !keys[a].exact() && values[a] < values[b];
+    } );
+
+    //order[i] is the index of the value that belongs at i
+    for ( size_t i = 0; i < order.size(); i++ )
+    {
+        size_t at = i;
+
+        while ( order[at] != i )
+        {
+            size_t from = order[at];
+            values[at].swap( values[from] );
+            swap( keys[at], keys[from] );
+            order[at] = at;
+            at = from;
+        }
+        order[at] = at;
+    }
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Sorts LargeInts into ascending order. Most comparisons
+ * are settled by the length and first 18 digits cached in each key; only
+ * values whose keys tie are compared digit by digit.
+ *
+ * @params[in,out] values - LargeInts to sort
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void sort_largeints( vector<LargeInt>& values )
+{
+    vector<LargeIntKey> keys;
+
+    sortKeyed( values, keys );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Sorts LargeInts and removes the duplicates. After the
+ * sort, equal values are next to each other, and a value differs from the
+ * last one kept whenever its key differs; the digits are only compared
+ * when the keys match and do not hold the whole number.
+ *
+ * @params[in,out] values - LargeInts to sort and deduplicate
+ *
+ * @returns none
+ *
+ * *****************************************************/
+void unique_largeints( vector<LargeInt>& values )
+{
+    vector<LargeIntKey> keys;
+    size_t kept = 0;
+
+    sortKeyed( values, keys );
+    for ( size_t i = 0; i < values.size(); i++ )
+    {
+        if ( kept > 0 && keys[i] == keys[kept - 1] &&
+            ( keys[i].exact() || values[i] == values[kept - 1] ) )
+            continue;
+
+        if ( i != kept )
+        {
+            values[kept].swap( values[i] );
+            keys[kept] = keys[i];
+        }
+        kept++;
+    }
+
+    values.erase( values.begin() + kept, values.end() );
+}
@@ -0,0 +1,473 @@
+/* @file
+ * @brief This file contains the SparseInt class, which keeps only the
+ * nonzero digits of a number: constructors, conversions, terms, operator+,
+ * operator*, compare, the comparison operators and operator<<.
+ * */
+#include "largeint.h"
+#include <algorithm>
+
+/*******************************************************
+ *      Function Prototypes for ASL Functions
+ *******************************************************/
+ListNode* asl_new( int coeff = 0, int power = 0, ListNode* next = nullptr, 
+    ListNode* prev = nullptr );
+void asl_delete( ListNode* delnode );
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Adds a digit in front of the list being built from the
+ * least significant end. Zero digits are skipped, and an empty list is
+ * left to finishList().
+ *
+ * @params[in,out] head  - most significant node so far, nullptr if none
+ * @params[in,out] tail  - least significant node, nullptr if none
+ * @params[in]     coeff - digit to add
+ * @params[in]     power - power of the digit, above all powers so far
+ *
+ * @returns none
+ *
+ * *****************************************************/
+static void prependTerm( ListNode*& head, ListNode*& tail, int coeff, 
+    unsigned power )
+{
+    if ( coeff == 0 )
+        return;
+
+    ListNode* node = asl_new( coeff, power, head );
+    if ( head != nullptr )
+        head->prev = node;
+    else
+        tail = node;
+    head = node;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Gives a list with no nonzero digits the single 0 node
+ * that stands for zero.
+ *
+ * @params[in,out] head - most significant node, nullptr if none
+ * @params[in,out] tail - least significant node, nullptr if none
+ *
+ * @returns none
+ *
+ * *****************************************************/
+static void finishList( ListNode*& head, ListNode*& tail )
+{
+    if ( head == nullptr )
+        head = tail = asl_new();
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Makes digit * 10^power in one node.
+ *
+ * @params[in]  digit - digit from 0 to 9
+ * @params[in]  power - power of 10
+ *
+ * @returns none
+ *
+ * *****************************************************/
+SparseInt::SparseInt( int digit, unsigned power )
+{
+    freePoly();
+    head = tail = ( digit == 0 ) ? asl_new() : asl_new( digit, power );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Converts a LargeInt to sparse form by leaving out its
+ * zero digits.
+ *
+ * @params[in]  value - LargeInt to convert
+ *
+ * @returns none
+ *
+ * *****************************************************/
+SparseInt::SparseInt( const LargeInt& value )
+{
+    freePoly();
+    for ( ListNode* curr = value.tail; curr != nullptr; curr = curr->prev )
+        prependTerm( head, tail, curr->coeff, curr->power );
+    finishList( head, tail );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Converts back to a LargeInt, filling in the zero
+ * digits between the nodes.
+ *
+ * @params  none
+ *
+ * @returns the number as a LargeInt
+ *
+ * *****************************************************/
+LargeInt SparseInt::to_largeint() const
+{
+    vector<int> num( head->power + 1, 0 );
+    LargeInt result;
+
+    for ( ListNode* curr = head; curr != nullptr; curr = curr->next )
+        num[curr->power] = curr->coeff;
+    result.fromDigits( num );
+    return result;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Shares the list of another SparseInt.
+ *
+ * @params[in]  value - SparseInt to be copied
+ *
+ * @returns *this
+ *
+ * *****************************************************/
+const SparseInt& SparseInt::operator=( const SparseInt& value )
+{
+    if ( this != &value )
+        copyPoly( value );
+    return *this;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Counts the nonzero digits.
+ *
+ * @params  none
+ *
+ * @returns number of nonzero digits
+ *
+ * *****************************************************/
+unsigned SparseInt::terms() const
+{
+    unsigned count = 0;
+
+    for ( ListNode* curr = tail; curr != nullptr; curr = curr->prev )
+        if ( curr->coeff != 0 )
+            count++;
+    return count;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Adds two SparseInts by merging their lists from the
+ * least significant end. A carry is placed one power above the digit that
+ * made it, and it merges with a term at that power if there is one, so the
+ * work is in the number of terms plus the length of any run of carries.
+ *
+ * @params[in]  lhs - first SparseInt to be added
+ * @params[in]  rhs - second SparseInt to be added
+ *
+ * @returns sum - lhs + rhs
+ *
+ * *****************************************************/
+SparseInt operator+( const SparseInt& lhs, const SparseInt& rhs )
+{
+    SparseInt sum;
+    ListNode* x = lhs.tail;
+    ListNode* y = rhs.tail;
+    unsigned carryPower = 0;
+    int carry = 0;
+
+    sum.freePoly();
+    while ( x != nullptr || y != nullptr || carry != 0 )
+    {
+        //lowest power still to be added
+        unsigned power = carry != 0 ? carryPower : UINT32_MAX;
+        if ( x != nullptr )
+            power = min<unsigned>( power, x->power );
+        if ( y != nullptr )
+            power = min<unsigned>( power, y->power );
+
+        int total = 0;
+        if ( carry != 0 && carryPower == power )
+        {
+            total = carry;
+            carry = 0;
+        }
+        if ( x != nullptr && unsigned( x->power ) == power )
+        {
+            total += x->coeff;
+            x = x->prev;
+        }
+        if ( y != nullptr && unsigned( y->power ) == power )
+        {
+            total += y->coeff;
+            y = y->prev;
+        }
+
+        prependTerm( sum.head, sum.tail, total % 10, power );
+        carry = total / 10;
+        carryPower = power + 1;
+    }
+    finishList( sum.head, sum.tail );
+
+    return sum;
+}
+
+/*!
+* @brief one row of the products merged by operator*: a term of the side
+* with fewer terms times the terms of the other side, taken upward from
+* the least significant one
+*/
+struct ProductRow
+{
+    unsigned power; /*!< power of the row's next product */
+    ListNode* x;    /*!< term of the side with fewer terms */
+    ListNode* y;    /*!< next term of the other side */
+};
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Orders the rows of operator* so the heap keeps the row
+ * with the lowest next power on top.
+ *
+ * @params[in]  lhs - first row
+ * @params[in]  rhs - second row
+ *
+ * @returns true if lhs comes after rhs
+ *
+ * *****************************************************/
+static bool laterRow( const ProductRow& lhs, const ProductRow& rhs )
+{
+    return lhs.power > rhs.power;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Multiplies two SparseInts. Every term of the side with
+ * fewer terms makes one row of products, already in order of power, and
+ * the rows are merged through a heap holding the next product of each, so
+ * only those products are kept at once. Products at the same power are
+ * added up as they come off the heap and carried from the least
+ * significant end. A carry only spills into the powers after its own until
+ * it runs out, so the work is the number of pairs of terms times the log
+ * of the number of rows.
+ *
+ * @params[in]  lhs - SparseInt multiplicand
+ * @params[in]  rhs - SparseInt multiplier
+ *
+ * @returns product - lhs * rhs
+ *
+ * *****************************************************/
+SparseInt operator*( const SparseInt& lhs, const SparseInt& rhs )
+{
+    const SparseInt* rows = &lhs;
+    const SparseInt* cols = &rhs;
+    vector<ProductRow> heap;
+    SparseInt product;
+
+    if ( lhs.terms() > rhs.terms() )
+        swap( rows, cols );
+
+    //the lowest nonzero term of the other side starts every row
+    ListNode* first = cols->tail;
+    while ( first != nullptr && first->coeff == 0 )
+        first = first->prev;
+    if ( first != nullptr )
+        for ( ListNode* x = rows->tail; x != nullptr; x = x->prev )
+            if ( x->coeff != 0 )
+                heap.push_back( { unsigned( x->power + first->power ), 
+                    x, first } );
+    make_heap( heap.begin(), heap.end(), laterRow );
+
+    product.freePoly();
+    uint64_t carry = 0;
+    unsigned power = 0;
+    while ( !heap.empty() || carry != 0 )
+    {
+        //jump over powers with nothing to carry into them
+        if ( carry == 0 )
+            power = heap.front().power;
+
+        uint64_t total = carry;
+        while ( !heap.empty() && heap.front().power == power )
+        {
+            pop_heap( heap.begin(), heap.end(), laterRow );
+            ProductRow& row = heap.back();
+            total += uint64_t( row.x->coeff * row.y->coeff );
+
+            //move the row on to its next product, or drop it at its end
+            do
+                row.y = row.y->prev;
+            while ( row.y != nullptr && row.y->coeff == 0 );
+            if ( row.y == nullptr )
+                heap.pop_back();
+            else
+            {
+                row.power = row.x->power + row.y->power;
+                push_heap( heap.begin(), heap.end(), laterRow );
+            }
+        }
+
+        prependTerm( product.head, product.tail, total % 10, power );
+        carry = total / 10;
+        power++;
+    }
+    finishList( product.head, product.tail );
+
+    return product;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Compares two SparseInts from the most significant end.
+ * Where the lists first differ, a term at a higher power, or a larger
+ * coefficient at the same power, makes that number larger.
+ *
+ * @params[in]  num - SparseInt to compare to this one
+ *
+ * @returns -1, 0 or 1 as this is less than, equal to or greater than num
+ *
+ * *****************************************************/
+int SparseInt::compare( const SparseInt& num ) const
+{
+    ListNode* x = head;
+    ListNode* y = num.head;
+
+    while ( x != nullptr && y != nullptr )
+    {
+        if ( x->power != y->power )
+            return ( x->power > y->power ) ? 1 : -1;
+        if ( x->coeff != y->coeff )
+            return ( x->coeff > y->coeff ) ? 1 : -1;
+        x = x->next;
+        y = y->next;
+    }
+
+    //any nonzero terms left over decide it
+    if ( x != nullptr && x->coeff != 0 )
+        return 1;
+    if ( y != nullptr && y->coeff != 0 )
+        return -1;
+    return 0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Tests whether lhs is equal to rhs.
+ *
+ * @params[in]  lhs - SparseInt to the left of the operator
+ * @params[in]  rhs - SparseInt to the right of the operator
+ *
+ * @returns boolean result of the comparison
+ *
+ * *****************************************************/
+bool operator==( const SparseInt& lhs, const SparseInt& rhs )
+{
+    return lhs.compare( rhs ) == 0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Tests whether lhs is not equal to rhs.
+ *
+ * @params[in]  lhs - SparseInt to the left of the operator
+ * @params[in]  rhs - SparseInt to the right of the operator
+ *
+ * @returns boolean result of the comparison
+ *
+ * *****************************************************/
+bool operator!=( const SparseInt& lhs, const SparseInt& rhs )
+{
+    return lhs.compare( rhs ) != 0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Tests whether lhs is less than or equal to rhs.
+ *
+ * @params[in]  lhs - SparseInt to the left of the operator
+ * @params[in]  rhs - SparseInt to the right of the operator
+ *
+ * @returns boolean result of the comparison
+ *
+ * *****************************************************/
+bool operator<=( const SparseInt& lhs, const SparseInt& rhs )
+{
+    return lhs.compare( rhs ) <= 0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Tests whether lhs is greater than or equal to rhs.
+ *
+ * @params[in]  lhs - SparseInt to the left of the operator
+ * @params[in]  rhs - SparseInt to the right of the operator
+ *
+ * @returns boolean result of the comparison
+ *
+ * *****************************************************/
+bool operator>=( const SparseInt& lhs, const SparseInt& rhs )
+{
+    return lhs.compare( rhs ) >= 0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Tests whether lhs is less than rhs.
+ *
+ * @params[in]  lhs - SparseInt to the left of the operator
+ * @params[in]  rhs - SparseInt to the right of the operator
+ *
+ * @returns boolean result of the comparison
+ *
+ * *****************************************************/
+bool operator<( const SparseInt& lhs, const SparseInt& rhs )
+{
+    return lhs.compare( rhs ) < 0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Tests whether lhs is greater than rhs.
+ *
+ * @params[in]  lhs - SparseInt to the left of the operator
+ * @params[in]  rhs - SparseInt to the right of the operator
+ *
+ * @returns boolean result of the comparison
+ *
+ * *****************************************************/
+bool operator>( const SparseInt& lhs, const SparseInt& rhs )
+{
+    return lhs.compare( rhs ) > 0;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Writes the decimal digits of a SparseInt. toChars()
+ * fills the zeros between the terms, and the digits go to the stream in
+ * one write.
+ *
+ * @params[in]  out - ostream to write to
+ * @params[in]  num - SparseInt to write
+ *
+ * @returns out - ostream
+ *
+ * *****************************************************/
+ostream& operator<<( ostream& out, const SparseInt& num )
+{
+    string text( num.length(), '0' );
+
+    num.toChars( &text[0] );
+    return out.write( text.data(), text.size() );
+}
@@ -0,0 +1,256 @@
+/* @file
+ * @brief Tuning tool for the LargeInt class. Times the algorithms on both
+ * sides of each crossover point on this machine and writes the best
+ * switch points as a tuning.h for the library to be rebuilt with.
+ *
+ * Usage: tune [file]
+ *
+ * The profile is written to file, or to tuning.h if no file is given, and
+ * the timings are reported on stdout. "make autotune" runs this and then
+ * rebuilds the programs.
+ * */
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+using namespace std;
+
+#include "largeint.h"
+
+/*!
+* @brief each timing repeats the operation for at least this many seconds
+*/
+static const double TIME_SLICE = 0.02;
+
+/*!
+* @brief karatsuba_digits values tried, the last one never using Karatsuba
+*/
+static const unsigned KARATSUBA_TRIES[] = { 8, 12, 16, 24, 32, 48, 64, 96,
+    128, 192, 256, 1u << 30 };
+
+/*!
+* @brief operand sizes the karatsuba_digits values are scored on
+*/
+static const unsigned KARATSUBA_SIZES[] = { 64, 128, 256, 512, 1024, 2048 };
+
+/*!
+* @brief modulus sizes where division and Barrett reduction are compared
+*/
+static const unsigned BARRETT_SIZES[] = { 20, 24, 32, 40, 48, 64, 80, 96,
+    128, 160, 192, 256 };
+
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Makes a random LargeInt with exactly the given number
+ * of digits.
+ *
+ * @params[in]     digits - number of digits, at least 1
+ * @params[in,out] rng    - random number generator
+ *
+ * @returns the random LargeInt
+ *
+ * *****************************************************/
+static LargeInt randomNumber( unsigned digits, mt19937& rng )
+{
+    string text( digits, '0' );
+
+    for ( char& c : text )
+        c = '0' + rng() % 10;
+    text[0] = '1' + rng() % 9;
+    return LargeInt( text );
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Times an operation, repeating it for at least
+ * TIME_SLICE seconds, and keeps the best of three such runs.
+ *
+ * @params[in]  op - operation to time
+ *
+ * @returns seconds per call of op
+ *
+ * *****************************************************/
+static double timeIt( const function<void()>& op )
+{
+    double best = 0;
+
+    for ( int run = 0; run < 3; run++ )
+    {
+        auto start = chrono::steady_clock::now();
+        double seconds = 0;
+        unsigned calls = 0;
+
+        while ( seconds < TIME_SLICE )
+        {
+            op();
+            calls++;
+            seconds = chrono::duration<double>(
+                chrono::steady_clock::now() - start ).count();
+        }
+
+        if ( run == 0 || seconds / calls < best )
+            best = seconds / calls;
+    }
+    return best;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds the karatsuba_digits value with the lowest
+ * multiplication times. Each value is scored by its time at every size in
+ * KARATSUBA_SIZES relative to plain schoolbook at that size, so every size
+ * counts the same.
+ *
+ * @params[in,out] rng - random number generator
+ *
+ * @returns best karatsuba_digits
+ *
+ * *****************************************************/
+static unsigned tuneKaratsuba( mt19937& rng )
+{
+    size_t tries = sizeof( KARATSUBA_TRIES ) / sizeof( unsigned );
+    size_t sizes = sizeof( KARATSUBA_SIZES ) / sizeof( unsigned );
+    vector<double> score( tries, 0 );
+
+    for ( size_t s = 0; s < sizes; s++ )
+    {
+        LargeInt a = randomNumber( KARATSUBA_SIZES[s], rng );
+        LargeInt b = randomNumber( KARATSUBA_SIZES[s], rng );
+        vector<double> times( tries );
+
+        for ( size_t t = 0; t < tries; t++ )
+        {
+            karatsuba_digits = KARATSUBA_TRIES[t];
+            times[t] = timeIt( [&] { LargeInt p = a * b; } );
+        }
+
+        cout << "multiply " << KARATSUBA_SIZES[s] << " digits:";
+        for ( size_t t = 0; t < tries; t++ )
+        {
+            score[t] += times[t] / times[tries - 1];
+            cout << " " << times[t] * 1e6;
+        }
+        cout << " us" << endl;
+    }
+
+    size_t best = min_element( score.begin(), score.end() ) - score.begin();
+    return KARATSUBA_TRIES[best];
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Finds the smallest modulus size from which Barrett
+ * reduction beats division for mulmod at every larger size measured.
+ *
+ * @params[in,out] rng - random number generator
+ *
+ * @returns best barrett_digits
+ *
+ * *****************************************************/
+static unsigned tuneBarrett( mt19937& rng )
+{
+    size_t sizes = sizeof( BARRETT_SIZES ) / sizeof( unsigned );
+    unsigned crossover = 1u << 30;
+
+    for ( size_t s = sizes; s-- > 0; )
+    {
+        LargeInt m = randomNumber( BARRETT_SIZES[s], rng );
+        LargeInt a = randomNumber( BARRETT_SIZES[s], rng ) % m;
+        LargeInt b = randomNumber( BARRETT_SIZES[s], rng ) % m;
+
+        barrett_digits = 1u << 30;
+        ModContext divide( m );
+        barrett_digits = 0;
+        ModContext barrett( m );
+
+        double plain = timeIt( [&] { LargeInt r = divide.mulmod( a, b ); } );
+        double fast = timeIt( [&] { LargeInt r = barrett.mulmod( a, b ); } );
+        cout << "mulmod " << BARRETT_SIZES[s] << " digits: division "
+            << plain * 1e6 << " us, Barrett " << fast * 1e6 << " us" << endl;
+
+        //sizes are measured from the top, so stop at the first loss
+        if ( fast >= plain )
+            break;
+        crossover = BARRETT_SIZES[s];
+    }
+    return crossover;
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Writes the tuning profile as a header of constexpr
+ * constants.
+ *
+ * @params[in]  out       - stream to write to
+ * @params[in]  karatsuba - value for KARATSUBA_DIGITS
+ * @params[in]  barrett   - value for BARRETT_DIGITS
+ *
+ * @returns none
+ *
+ * *****************************************************/
+static void writeProfile( ostream& out, unsigned karatsuba, unsigned barrett )
+{
+    out << "/* @file\n"
+        " * @brief Algorithm crossover points for this machine, in decimal "
+        "digits.\n"
+        " * Written by the tune tool (\"make autotune\"); the library starts "
+        "its\n"
+        " * karatsuba_digits and barrett_digits at these values.\n"
+        " * */\n"
+        "#ifndef __TUNING_H\n"
+        "#define __TUNING_H\n\n"
+        "// multiply: schoolbook below this many digits, Karatsuba at or "
+        "above\n"
+        "constexpr unsigned KARATSUBA_DIGITS = " << karatsuba << ";\n\n"
+        "// ModContext: plain division below this many digits, Barrett at or "
+        "above\n"
+        "constexpr unsigned BARRETT_DIGITS = " << barrett << ";\n\n"
+        "#endif\n";
+}
+
+/********************************************************
+ * @author agent
+ *
+ * @par Description: Measures the crossover points and writes the profile.
+ *
+ * @params[in]  argc - number of arguments
+ * @params[in]  argv - program name and optional output file
+ *
+ * @returns 0 on success, 1 if the profile could not be written
+ *
+ * *****************************************************/
+int main( int argc, char *argv[] )
+{
+    string path = ( argc > 1 ) ? argv[1] : "tuning.h";
+    mt19937 rng( 315 );
+
+    if ( argc > 2 )
+    {
+        cerr << "usage: " << argv[0] << " [file]" << endl;
+        return 1;
+    }
+
+    //Barrett reduction is timed with the tuned multiply
+    unsigned karatsuba = tuneKaratsuba( rng );
+    karatsuba_digits = karatsuba;
+    unsigned barrett = tuneBarrett( rng );
+    cout << "KARATSUBA_DIGITS = " << karatsuba << endl;
+    cout << "BARRETT_DIGITS = " << barrett << endl;
+
+    ofstream out( path );
+    writeProfile( out, karatsuba, barrett );
+    if ( !out )
+    {
+        cerr << "tune: cannot write " << path << endl;
+        return 1;
+    }
+    return 0;
+}
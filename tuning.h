@@ -0,0 +1,15 @@
+/* @file
+ * @brief Algorithm crossover points for this machine, in decimal digits.
+ * Written by the tune tool ("make autotune"); the library starts its
+ * karatsuba_digits and barrett_digits at these values.
+ * */
+#ifndef __TUNING_H
+#define __TUNING_H
+
+// multiply: schoolbook below this many digits, Karatsuba at or above
+constexpr unsigned KARATSUBA_DIGITS = 32;
+
+// ModContext: plain division below this many digits, Barrett at or above
+constexpr unsigned BARRETT_DIGITS = 24;
+
+#endif